@@ -53,6 +53,7 @@ void gui::ElementViewWidget::on_btnRefreshSpecificInfo_clicked()
 		res = QString::number(m_element->AsFile()->Size());
 		break;
 	case dbc::ElementTypeFolder:
+		res = QString::number(m_element->AsFolder()->TotalSize());
 		break;
 	case dbc::ElementTypeSymLink:
 		res = model::utils::StdString2QString(m_element->AsSymLink()->TargetPath());
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+namespace dbc
+{
+	enum TuningProfile
+	{
+		TuningProfileCompatible = 0, // Rollback journal and full synchronization, like the containers of the previous versions
+		TuningProfileBalanced, // WAL journal with normal synchronization, larger page cache and memory mapped I/O
+		TuningProfileThroughput // WAL journal without synchronization. The last transactions may be lost on the power failure
+	};
+
+	enum DbJournalMode
+	{
+		DbJournalModeDelete = 0,
+		DbJournalModeTruncate,
+		DbJournalModePersist,
+		DbJournalModeWal
+	};
+
+	enum DbSynchronousMode
+	{
+		DbSynchronousOff = 0,
+		DbSynchronousNormal,
+		DbSynchronousFull
+	};
+
+	enum DbTempStore
+	{
+		DbTempStoreDefault = 0,
+		DbTempStoreFile,
+		DbTempStoreMemory
+	};
+
+	// SQLite tuning of the container's database. It is applied on every CreateContainer() and Connect().
+	class ConnectionOptions
+	{
+	public:
+		explicit ConnectionOptions(TuningProfile profile = TuningProfileCompatible);
+
+		DbJournalMode JournalMode() const;
+		DbSynchronousMode Synchronous() const;
+		unsigned int CacheSizeKb() const;
+		uint64_t MmapSize() const; // in bytes, 0 disables memory mapped I/O
+		DbTempStore TempStore() const;
+		bool IncrementalVacuum() const; // FULL auto-vacuum is used if disabled
+		unsigned int VacuumStepPages() const; // Max pages released by one IContainer::IdleVacuum() call
+		size_t StatementsCacheSize() const; // Max idle prepared statements kept by the connection
+		size_t ReadConnectionsCount() const; // Max read-only connections used in WAL mode, 0 - by the number of processor cores
+		size_t DentryCacheSize() const; // Max directory entries cached for the path resolution
+		// Elements reload their rows after the commits of the other processes too. It costs a query on every access to an element.
+		// The directory entries cache doesn't see such changes, it should be disabled with the shared access.
+		bool TrackExternalChanges() const;
+
+		void SetJournalMode(DbJournalMode mode);
+		void SetSynchronous(DbSynchronousMode mode);
+		void SetCacheSizeKb(unsigned int size);
+		void SetMmapSize(uint64_t size);
+		void SetTempStore(DbTempStore store);
+		void SetIncrementalVacuum(bool enabled);
+		void SetVacuumStepPages(unsigned int pages);
+		void SetStatementsCacheSize(size_t size);
+		void SetReadConnectionsCount(size_t count);
+		void SetDentryCacheSize(size_t size);
+		void SetTrackExternalChanges(bool enabled);
+
+	private:
+		DbJournalMode m_journalMode;
+		DbSynchronousMode m_synchronous;
+		unsigned int m_cacheSizeKb;
+		uint64_t m_mmapSize;
+		DbTempStore m_tempStore;
+		bool m_incrementalVacuum;
+		unsigned int m_vacuumStepPages;
+		size_t m_statementsCacheSize;
+		size_t m_readConnectionsCount;
+		size_t m_dentryCacheSize;
+		bool m_trackExternalChanges;
+	};
+}
@@ -3,16 +3,17 @@
 #include "IDataStorage.h"
 #include "Folder.h"
 #include "File.h"
+#include "FileWriter.h"
 #include <string>
 #include <limits>
 
 namespace dbc
 {
 	// Creates empty container
-	ContainerGuard CreateContainer(const std::string &path, const std::string &password);
-	ContainerGuard CreateContainer(const std::string &path, const std::string &password, IDataStorageGuard storage);
+	ContainerGuard CreateContainer(const std::string &path, const std::string &password, const ConnectionOptions& options = ConnectionOptions());
+	ContainerGuard CreateContainer(const std::string &path, const std::string &password, IDataStorageGuard storage, const ConnectionOptions& options = ConnectionOptions());
 
 	// Creates connection to the existing container
-	ContainerGuard Connect(const std::string &dbpath, const std::string &password);
-	ContainerGuard Connect(const std::string &dbpath, const std::string &password, IDataStorageGuard storage);
+	ContainerGuard Connect(const std::string &dbpath, const std::string &password, const ConnectionOptions& options = ConnectionOptions());
+	ContainerGuard Connect(const std::string &dbpath, const std::string &password, IDataStorageGuard storage, const ConnectionOptions& options = ConnectionOptions());
 }
\ No newline at end of file
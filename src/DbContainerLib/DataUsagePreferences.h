@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 
 namespace dbc
 {
@@ -9,27 +10,55 @@ namespace dbc
 		DataFragmentationLevelLarge
 	};
 
+	enum DataStorageGrowth // How much space the data storage preallocates when the new stream doesn't fit in it
+	{
+		DataStorageGrowthExact = 0, // Only the space of the new stream
+		DataStorageGrowthChunked, // Up to the next 1 MB boundary
+		DataStorageGrowthGeometric // 1/8 of the storage size, at least 1 MB and at most 64 MB
+	};
+
 	class DataUsagePreferences
 	{
 	public:
 		static const unsigned short CLUSTER_SIZE_MIN = 0;
 		static const unsigned short CLUSTER_SIZE_DEF = 3;
 		static const unsigned short CLUSTER_SIZE_MAX = 7;
+		static const unsigned int INLINE_DATA_THRESHOLD_MAX = 64 * 1024;
 
 	public:
 		DataUsagePreferences(
 			unsigned short clusterSizeLevel = CLUSTER_SIZE_DEF,
 			DataFragmentationLevel fragmentationLevel = DataFragmentationLevelNormal,
-			bool transactionalWrite = true);
+			bool transactionalWrite = true,
+			DataStorageGrowth storageGrowth = DataStorageGrowthGeometric,
+			unsigned int inlineDataThreshold = 0,
+			bool tailPacking = false);
 
 		unsigned short ClusterSizeLevel() const;
 		unsigned int ClusterSize() const; // in bytes
+		// The granularity of the streams allocated for the write of this size. It is ClusterSize() without AdaptiveClusterSize().
+		unsigned int ClusterSizeFor(uint64_t writeSize) const;
 		DataFragmentationLevel FragmentationLevel() const;
 		bool TransactionalWrite() const;
+		DataStorageGrowth StorageGrowth() const;
+		// The files smaller than this size are stored encrypted in the database instead of the streams. 0 disables it.
+		unsigned int InlineDataThreshold() const;
+		// The last partial cluster of the file is stored in the tail block shared with the tails of other files
+		bool TailPacking() const;
+		// The cluster size is chosen for every write from its size, up to ClusterSize()
+		bool AdaptiveClusterSize() const;
+		// The container samples the sizes of the writes and the streams of the written files and adjusts
+		// the cluster size level and the tail packing, see IContainer::GetTuningDecisions()
+		bool AutoTune() const;
 
 		void SetClusterSizeLevel(unsigned short level);
 		void SetFragmentationLevel(DataFragmentationLevel level);
 		void SetTransactionalWrite(bool enabled);
+		void SetStorageGrowth(DataStorageGrowth growth);
+		void SetInlineDataThreshold(unsigned int size); // Up to INLINE_DATA_THRESHOLD_MAX
+		void SetTailPacking(bool enabled);
+		void SetAdaptiveClusterSize(bool enabled);
+		void SetAutoTune(bool enabled);
 
 		static unsigned int GetRealClusterSize(unsigned short level);
 
@@ -38,5 +67,10 @@ namespace dbc
 		unsigned int m_clusterSize;
 		DataFragmentationLevel m_fragmentationLevel;
 		bool m_transactionalWrite;
+		DataStorageGrowth m_storageGrowth;
+		unsigned int m_inlineDataThreshold;
+		bool m_tailPacking;
+		bool m_adaptiveClusterSize;
+		bool m_autoTune;
 	};
 }
\ No newline at end of file
@@ -8,6 +8,7 @@ namespace dbc
 	public:
 		DirectLink(ContainerResources resources, int64_t id);
 		DirectLink(ContainerResources resources, int64_t parentId, const std::string& name);
+		DirectLink(ContainerResources resources, const ElementInfo& info);
 
         // Link
         virtual ElementGuard Target() override;
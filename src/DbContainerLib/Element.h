@@ -4,6 +4,7 @@
 #include "Types.h"
 #include "ErrorCodes.h"
 #include <memory>
+#include <mutex>
 
 namespace dbc
 {
@@ -13,17 +14,26 @@ namespace dbc
 	class File;
 	class SymLink;
 	class DirectLink;
+	struct ElementInfo;
 
 	typedef std::shared_ptr<Folder> FolderGuard;
 	typedef std::shared_ptr<File> FileGuard;
 
+	class ElementsIdentityMap;
+
+	// The lookups of the same element return the same object while it is held (see ElementsIdentityMap),
+	// so the loaded row is shared by the holders and guarded by m_rowMutex.
 	class Element
 	{
+		friend class ElementsIdentityMap;
+
 	public:
 		Element(ContainerResources resources, int64_t id);
 		Element(ContainerResources resources, int64_t parentId, const std::string& name);
+		Element(ContainerResources resources, const ElementInfo& info); // Doesn't query the database
 
 		virtual bool Exists();
+		int64_t Id() const throw(); // The key of Container::GetInfoBatch()
         virtual std::string Name();
 		virtual std::string Path();
         virtual ElementType Type() const throw();
@@ -48,10 +58,12 @@ namespace dbc
 		static Error s_notFoundError;
 
 	protected:
-		void Refresh();
+		void Refresh(); // Reloads the row only if the container was changed since it was loaded
 		bool Exists(int64_t id);
 		Error Exists(int64_t parent_id, std::string name); // Returns s_errElementNotFound (see .cpp) as false and SUCCESS as true, or other error code if there was an error
         void UpdateModifiedAndMetaData(const char* meta = nullptr);
+		void UpdateLinkTarget(const std::string& target);
+		void LoadMeta(); // Reads the meta into m_props if it isn't read since the row was loaded
 		int64_t GetId(const Element& element);
 
 	protected:
@@ -63,9 +75,13 @@ namespace dbc
 		std::string m_name;
         ElementProperties m_props;
 		RawData m_specificData;
+		std::string m_linkTarget; // FileSystem.target: the path of the symlink or the id of the direct link target
+		bool m_metaLoaded; // The meta is kept out of the FileSystem row, so it is read only by GetProperties()
+		uint64_t m_generation; // Connection::ChangeGeneration() before the row was loaded, 0 if unknown
+		mutable std::mutex m_rowMutex; // The loaded row and the meta of the shared object
 
 	private:
-        void InitElementInfo(int type, int64_t created, int64_t modified, const std::string& meta);
+        void InitElementInfo(int type, int64_t created, int64_t modified, const std::string& linkTarget);
 	};
 
 	typedef std::shared_ptr<Element> ElementGuard;
@@ -1,6 +1,7 @@
 #pragma once
 #include "Iterator.h"
 #include "Element.h"
+#include "ListFilter.h"
 #include "Types.h"
 
 namespace dbc
@@ -11,22 +12,52 @@ namespace dbc
 		int64_t ID;
 		int64_t ParentID;
 		ElementType Type;
+		// The rest of the FileSystem row, the element is constructed from it without querying the database
+		std::string Name;
+		int64_t Created;
+		int64_t Modified;
+		std::string Target; // Of the links, the meta isn't in the row (see Element::GetProperties())
+		uint64_t Size; // Bytes used by the file, 0 for the other elements
+		uint64_t Generation; // Connection::ChangeGeneration() before the row was read, 0 if unknown
 
 		ElementInfo()
-			: ID(-1), ParentID(-1), Type(ElementTypeUnknown)
+			: ID(-1), ParentID(-1), Type(ElementTypeUnknown), Created(0), Modified(0), Size(0), Generation(0)
 		{ }
 
 		ElementInfo(int64_t id, int64_t parent_id, ElementType type)
-			: ID(id), ParentID(parent_id), Type(type)
+			: ID(id), ParentID(parent_id), Type(type), Created(0), Modified(0), Size(0), Generation(0)
+		{ }
+
+		ElementInfo(int64_t id, int64_t parent_id, ElementType type, const std::string& name, int64_t created, int64_t modified, const std::string& target)
+			: ID(id), ParentID(parent_id), Type(type), Name(name), Created(created), Modified(modified), Target(target), Size(0), Generation(0)
 		{ }
 	};
 
 	typedef std::vector<ElementInfo> ElementInfo_vt;
 
+	// The properties of the element for the views and the indexers without the meta itself (see Container::GetInfoBatch())
+	struct ElementSummary
+	{
+		int64_t ID;
+		int64_t ParentID;
+		std::string Name;
+		ElementType Type;
+		int64_t Created;
+		int64_t Modified;
+		uint64_t Size; // Bytes used by the file, 0 for the other elements
+		uint64_t MetaLength; // In bytes, 0 for the links: their meta is the meta of the target
+
+		ElementSummary()
+			: ID(-1), ParentID(-1), Type(ElementTypeUnknown), Created(0), Modified(0), Size(0), MetaLength(0)
+		{ }
+	};
+
+	typedef std::vector<ElementSummary> ElementSummaries_vt;
+
 	class ElementsIterator: public Iterator<ElementGuard>
 	{
 	public:
-		ElementsIterator(ContainerResources resources, int64_t folder_id);
+		ElementsIterator(ContainerResources resources, int64_t folder_id, const ListFilter& filter = ListFilter());
 
 		virtual ElementGuard Next();
 
@@ -36,5 +67,39 @@ namespace dbc
 		ElementInfo_vt m_info;
 	};
 
+	// Fetches the children by pages in the order of their names (keyset pagination on (parent_id, name)),
+	// so only one page is kept in memory and the first elements are available without reading the whole folder.
+	// The elements created or removed during the enumeration are returned or skipped if they are after the already fetched page.
+	class PagedElementsIterator: public Iterator<ElementGuard>
+	{
+	public:
+		static const size_t DEFAULT_PAGE_SIZE = 1000;
+
+		// Starts after the child with the name startAfter, from the first child if it is empty
+		PagedElementsIterator(ContainerResources resources, int64_t folder_id, size_t pageSize = DEFAULT_PAGE_SIZE, const std::string& startAfter = "");
+
+		virtual bool HasNext() const;
+		virtual ElementGuard Next();
+		virtual void Rewind();
+		virtual bool Empty() const;
+		virtual size_t Count() const; // Queries the current number of the children
+
+		const std::string& LastKey() const; // The name of the last returned child, the enumeration can be continued after it
+
+	private:
+		void FetchPage();
+
+	private:
+		int64_t m_folderId;
+		ContainerResources m_resources;
+		size_t m_pageSize;
+		std::string m_startAfter;
+		std::string m_lastKey;
+		ElementInfo_vt m_page;
+		size_t m_pagePosition;
+		bool m_lastPage;
+	};
+
     using DbcElementsIterator = std::unique_ptr<Iterator<ElementGuard>>;
+    using DbcPagedElementsIterator = std::unique_ptr<PagedElementsIterator>;
 }
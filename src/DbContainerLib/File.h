@@ -7,17 +7,22 @@ namespace dbc
 	class Container;
 	union Error;
 	class FileStreamsManager;
+	class FileWriter;
+	typedef std::shared_ptr<FileWriter> FileWriterGuard;
 
 	class File: public Element
 	{
+		friend class FileWriter;
+
 	public:
 		File(ContainerResources resources, int64_t id);
 		File(ContainerResources resources, int64_t parentId, const std::string& name);
+		File(ContainerResources resources, const ElementInfo& info);
 		~File();
 
 		virtual void Remove();
 
-		FileGuard Clone() const;
+		FileGuard Clone() const; // Separate object, which isn't shared with the lookups of this file. It can be opened independently.
 
 		void Open(ReadWriteAccess access);
 		bool IsOpened() const;
@@ -29,6 +34,10 @@ namespace dbc
 		uint64_t Read(std::ostream& out, uint64_t size = 0, IProgressObserver* observer = nullptr);
 		uint64_t Write(std::istream& in, uint64_t size, IProgressObserver* observer = nullptr);
 		void Clear();
+		// Write session, which accepts the data by chunks and allocates the streams only when its buffer is flushed.
+		// The writer works with its own clone of this file, so this object should not be opened for writing.
+		// The buffer size 0 means FileWriter::DEFAULT_BUFFER_SIZE.
+		FileWriterGuard OpenWriter(size_t bufferSize = 0);
 
 		struct SpaceUsageInfo
 		{
@@ -48,6 +57,11 @@ namespace dbc
 		uint64_t DirectWrite(std::istream& in, uint64_t size, IProgressObserver* observer);
 		uint64_t TransactionalWrite(std::istream& in, uint64_t size, IProgressObserver* observer);
 		uint64_t WriteImpl(std::istream& in, uint64_t size, bool writeOnlyToUnusedStreams, IProgressObserver* observer);
+		uint64_t Append(std::istream& in, uint64_t size); // Used by FileWriter. The data is written to the new streams after the used ones.
+		// The files smaller than DataUsagePreferences::InlineDataThreshold() are stored in InlineData without the streams
+		uint64_t InlineRead(std::ostream& out, uint64_t size, IProgressObserver* observer);
+		uint64_t InlineWrite(std::istream& in, uint64_t size, IProgressObserver* observer);
+		void ReleaseStreams(); // Used when all data of the file is stored inline or in the tail block
 		void GetSpaceUsageInfoImpl(FileStreamsManager* streamsManager, SpaceUsageInfo& info);
 
 	private:
@@ -0,0 +1,37 @@
+#pragma once
+#include "File.h"
+#include <string>
+
+namespace dbc
+{
+	// Write session of the file, see File::OpenWriter(). The written chunks are collected in the buffer,
+	// the streams are allocated only when it is flushed. If the whole data fits the buffer, it is written
+	// on Close() with the known size, so the allocator can place it into one stream.
+	// The first flush replaces the content of the file, the next ones append to it. The flushed data stays
+	// in the file if the session fails later. The file is locked for writing until the writer is closed.
+	class FileWriter
+	{
+	public:
+		static const size_t DEFAULT_BUFFER_SIZE = 4 * 1024 * 1024;
+
+		FileWriter(FileGuard file, size_t bufferSize = DEFAULT_BUFFER_SIZE);
+		~FileWriter(); // Closes the writer, the errors are only logged
+		FileWriter(const FileWriter&) = delete;
+		FileWriter& operator=(const FileWriter&) = delete;
+
+		void Write(const char* data, size_t size);
+		uint64_t Write(std::istream& in, uint64_t size); // Returns the size read from the stream
+		void Flush();
+		void Close();
+
+		bool IsClosed() const;
+		uint64_t Written() const; // Including the buffered data
+
+	private:
+		FileGuard m_file;
+		std::string m_buffer;
+		size_t m_bufferSize;
+		uint64_t m_flushed;
+		bool m_closed;
+	};
+}
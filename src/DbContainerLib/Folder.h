@@ -3,37 +3,69 @@
 #include "ElementsIterator.h"
 #include "SymLink.h"
 #include "DirectLink.h"
+#include "IProgressObserver.h"
 
 namespace dbc
 {
 	class Connection;
 
+	// Description of the element created by Folder::CreateChildren()
+	struct ChildSpec
+	{
+		ChildSpec(const std::string& name, ElementType type, const std::string& meta = "")
+			: name(name), type(type), meta(meta)
+		{ }
+
+		std::string name;
+		ElementType type; // Folder, file or symlink. Direct links need the target element, use Folder::CreateDirectLink()
+		std::string meta; // Target path for symlinks
+	};
+
+	typedef std::vector<ChildSpec> ChildSpecs_vt;
+	typedef std::vector<ElementGuard> ElementGuards_vt;
+
 	class Folder: public Element
 	{
 	public:
 		Folder(ContainerResources resources, int64_t id);
 		Folder(ContainerResources resources, int64_t parentId, const std::string& name);
+		Folder(ContainerResources resources, const ElementInfo& info);
 
 		virtual std::string Name(); // optimized for the root
 		virtual std::string Path(); // optimized for the root
 		virtual void Remove();
+		void Remove(IProgressObserver* observer); // Removes the whole subtree and frees the streams of its files
 		virtual void Rename(const std::string& newName);
 
-		FolderGuard Clone() const;
+		FolderGuard Clone() const; // Separate object, which isn't shared with the lookups of this folder
 		bool IsRoot() const;
 		bool HasChildren();
+		// The aggregates of the subtree are maintained by the container on every change, so they are read without walking it
+		uint64_t ChildrenCount();
+		uint64_t DescendantCount(); // All elements of the subtree except the folder itself
+		uint64_t TotalSize(); // Bytes used by all files of the subtree
 		ElementGuard GetChild(const std::string& name);
         ElementGuard CreateChild(const std::string& name, ElementType type, const std::string& meta = "");
         FolderGuard CreateFolder(const std::string& name, const std::string& meta = "");
         FileGuard CreateFile(const std::string& name, const std::string& meta = "");
+		// Creates all children in one transaction or nothing if any of them is invalid or already exists.
+		// Returns the created elements in the order of specs.
+		ElementGuards_vt CreateChildren(const ChildSpecs_vt& children);
 
         SymLinkGuard CreateSymLink(const std::string& name, const std::string& targetPath);
         DirectLinkGuard CreateDirectLink(const std::string& name, const ElementGuard target);
 
 		DbcElementsIterator EnumFsEntries();
+		DbcElementsIterator EnumFsEntries(const ListFilter& filter); // Only the matching children are read
+		// Children in the order of their names, fetched by pages of pageSize, after the child with the name startAfter if it isn't empty
+		DbcPagedElementsIterator EnumFsEntriesPaged(size_t pageSize = PagedElementsIterator::DEFAULT_PAGE_SIZE, const std::string& startAfter = "");
+		// The summaries of all children in the order of their names, read by one query without creating the elements
+		ElementSummaries_vt ListWithInfo();
 
 	private:
-		Error RemoveFolder(int64_t folderId); // Recursive
+		uint64_t ReadAggregate(const std::string& column);
+		void RemoveFolder(int64_t folderId, IProgressObserver* observer);
         void CreateChildEntry(const std::string& name, ElementType type, const std::string& meta);
+		void CreateChildrenEntries(const ChildSpecs_vt& children, ElementInfo_vt& created);
 	};
 }
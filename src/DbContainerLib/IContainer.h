@@ -1,7 +1,10 @@
 #pragma once
 #include "IContainerInfo.h"
 #include "Element.h"
+#include "Folder.h"
 #include "DataUsagePreferences.h"
+#include "ConnectionOptions.h"
+#include "TuningDecision.h"
 #include <string>
 
 namespace dbc
@@ -18,9 +21,25 @@ namespace dbc
 		virtual FolderGuard GetRoot() = 0;
 		virtual ElementGuard GetElement(const std::string &path) = 0;
 		virtual ContainerInfo GetInfo() = 0;
+		// Bulk version of Folder::CreateChildren() for the folder with the specified path
+		virtual ElementGuards_vt CreateElements(const std::string& folderPath, const ChildSpecs_vt& children) = 0;
+		// The summaries of the elements with the specified ids in their order, read by one query for up to 500 ids.
+		// The ids of the missing elements are skipped.
+		virtual ElementSummaries_vt GetInfoBatch(const std::vector<int64_t>& ids) = 0;
 
 		virtual DataUsagePreferences GetDataUsagePreferences() const = 0;
-		virtual void SetDataUsagePreferences(const DataUsagePreferences& prefs) = 0;
+		virtual void SetDataUsagePreferences(const DataUsagePreferences& prefs) = 0; // They are saved in the container
+
+		virtual ConnectionOptions GetConnectionOptions() const = 0;
+		// Releases at most ConnectionOptions::VacuumStepPages() free pages of the database. Call it when the container is idle.
+		// Returns true if there are more free pages to release. Does nothing if incremental vacuum is disabled.
+		virtual bool IdleVacuum() = 0;
+		// Merges the physically adjacent unused streams of the data storage into single streams. The released streams are
+		// merged on every write and removal, this pass is for the containers which were fragmented before. Call it when the container is idle.
+		// Returns the number of the streams merged into their neighbours.
+		virtual uint64_t CoalesceFreeSpace() = 0;
+		// The decisions of DataUsagePreferences::AutoTune(), the oldest first. The container keeps the last 100 of them.
+		virtual TuningDecisions_vt GetTuningDecisions() = 0;
 	};
 
 	typedef std::shared_ptr<IContainer> ContainerGuard;
@@ -13,7 +13,11 @@ namespace dbc
 		virtual uint64_t TotalElements() = 0;
 		virtual uint64_t TotalElements(ElementType type) = 0;
 		virtual uint64_t UsedSpace() = 0;
-		virtual uint64_t FreeSpace() = 0;
+		virtual uint64_t FreeSpace() = 0; // In the streams
+		virtual uint64_t ReservedSpace() = 0; // Preallocated by the data storage after the last stream, see DataStorageGrowth
+		virtual uint64_t InlineSpace() = 0; // Data of the files stored in the database, see DataUsagePreferences::InlineDataThreshold()
+		virtual uint64_t TailBlocksSpace() = 0; // Shared by the tails of the files, see DataUsagePreferences::TailPacking()
+		virtual uint64_t TailsSpace() = 0; // Used by the tails in the tail blocks
 		virtual uint64_t TotalStreams() = 0;
 		virtual uint64_t UsedStreams() = 0;
 	};
@@ -5,6 +5,7 @@
 #include <memory>
 #include "IProgressObserver.h"
 #include "Types.h"
+#include "DataUsagePreferences.h"
 
 namespace dbc
 {
@@ -20,6 +21,10 @@ namespace dbc
 		virtual void ResetPassword(const std::string& newPassword) = 0;
 		virtual void ClearData() = 0;
 		virtual void GetDataToSave(RawData& data) = 0; // Usually called when container is going to close this storage
+		// The end of the space used by the streams, reported by the container after opening. The space after it may be preallocated.
+		virtual void SetDataEnd(uint64_t end) = 0;
+		virtual void SetGrowth(DataStorageGrowth growth) = 0;
+		virtual uint64_t ReservedSpace() = 0; // Preallocated space after the data end
 
 		// Used by binary streams
 		virtual uint64_t Write(std::istream& data, uint64_t begin, uint64_t end, dbc::IProgressObserver* observer = nullptr) = 0;
@@ -28,6 +33,10 @@ namespace dbc
 		virtual uint64_t Erace(uint64_t begin, uint64_t end, dbc::IProgressObserver* observer = nullptr) = 0;
 
 		virtual uint64_t Append(uint64_t size, uint64_t& begin, dbc::IProgressObserver* observer = nullptr) = 0;
+
+		// Used for the data of the files stored in the database. The data is encrypted from its beginning, as a separate stream.
+		virtual void Encrypt(const RawData& data, RawData& result) = 0;
+		virtual void Decrypt(const RawData& data, RawData& result) = 0;
 	};
 
 	typedef std::auto_ptr<IDataStorage> IDataStorageGuard;
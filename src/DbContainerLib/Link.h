@@ -8,6 +8,7 @@ namespace dbc
     public:
         Link(ContainerResources resources, int64_t id);
         Link(ContainerResources resources, int64_t parentId, const std::string& name);
+        Link(ContainerResources resources, const ElementInfo& info);
 
         virtual ElementProperties GetProperties() override;
         virtual void SetMetaInformation(const std::string& meta) override;
@@ -0,0 +1,73 @@
+#pragma once
+#include "Types.h"
+#include <ctime>
+#include <string>
+
+namespace dbc
+{
+	enum ListTypeMask
+	{
+		ListTypeFolders = 1 << ElementTypeFolder,
+		ListTypeFiles = 1 << ElementTypeFile,
+		ListTypeSymLinks = 1 << ElementTypeSymLink,
+		ListTypeDirectLinks = 1 << ElementTypeDirectLink,
+		ListTypeAll = ListTypeFolders | ListTypeFiles | ListTypeSymLinks | ListTypeDirectLinks
+	};
+
+	enum ListNameMatch
+	{
+		ListNameAny = 0,
+		ListNamePrefix,
+		ListNameGlob // SQLite GLOB: case sensitive, with *, ? and [...]
+	};
+
+	enum ListSortOrder
+	{
+		ListSortNone = 0,
+		ListSortName,
+		ListSortNameDesc,
+		ListSortModified, // The children with the same time are sorted by name
+		ListSortModifiedDesc,
+		ListSortCreated,
+		ListSortCreatedDesc
+	};
+
+	// Conditions of Folder::EnumFsEntries(). They are applied by the database query, so only the matching children are read.
+	class ListFilter
+	{
+	public:
+		ListFilter();
+
+		unsigned int Types() const; // Combination of ListTypeMask
+		ListNameMatch NameMatch() const;
+		const std::string& NamePattern() const;
+		time_t ModifiedFrom() const;
+		time_t ModifiedTo() const;
+		time_t CreatedFrom() const;
+		time_t CreatedTo() const;
+		ListSortOrder SortOrder() const;
+		size_t Limit() const; // 0 - without a limit
+
+		bool HasModifiedRange() const;
+		bool HasCreatedRange() const;
+
+		void SetTypes(unsigned int types);
+		void SetNamePrefix(const std::string& prefix);
+		void SetNameGlob(const std::string& glob);
+		void SetModifiedRange(time_t from, time_t to); // Both bounds are inclusive
+		void SetCreatedRange(time_t from, time_t to);
+		void SetSortOrder(ListSortOrder order);
+		void SetLimit(size_t limit);
+
+	private:
+		unsigned int m_types;
+		ListNameMatch m_nameMatch;
+		std::string m_namePattern;
+		time_t m_modifiedFrom;
+		time_t m_modifiedTo;
+		time_t m_createdFrom;
+		time_t m_createdTo;
+		ListSortOrder m_sortOrder;
+		size_t m_limit;
+	};
+}
@@ -8,6 +8,7 @@ namespace dbc
 	public:
 		SymLink(ContainerResources resources, int64_t id);
 		SymLink(ContainerResources resources, int64_t parentId, const std::string& name);
+		SymLink(ContainerResources resources, const ElementInfo& info);
 
         // Link
         virtual ElementGuard Target() override;
@@ -19,9 +20,6 @@ namespace dbc
 
 	private:
 		void InitTarget(const std::string& target);
-
-	private:
-		const char* m_target;
 	};
 
 	typedef std::shared_ptr<SymLink> SymLinkGuard;
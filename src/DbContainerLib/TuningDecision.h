@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dbc
+{
+	// The decision of the auto-tuning of DataUsagePreferences, see DataUsagePreferences::AutoTune()
+	struct TuningDecision
+	{
+		TuningDecision()
+			: time(0), samples(0), medianWriteSize(0), averageStreams(0), wasteRatio(0)
+			, oldClusterSizeLevel(0), newClusterSizeLevel(0), oldTailPacking(false), newTailPacking(false)
+		{ }
+
+		int64_t time; // Seconds since the epoch
+		uint64_t samples; // Writes sampled since the previous decision
+		uint64_t medianWriteSize;
+		double averageStreams; // Used streams of the written files
+		double wasteRatio; // Space of the last partial clusters of the writes to their size with the new cluster size
+		unsigned short oldClusterSizeLevel;
+		unsigned short newClusterSizeLevel;
+		bool oldTailPacking;
+		bool newTailPacking;
+		std::string reason;
+
+		bool Changed() const
+		{
+			return oldClusterSizeLevel != newClusterSizeLevel || oldTailPacking != newTailPacking;
+		}
+	};
+
+	typedef std::vector<TuningDecision> TuningDecisions_vt;
+}
\ No newline at end of file
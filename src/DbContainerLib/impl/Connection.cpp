@@ -8,12 +8,24 @@
 
 dbc::Connection::Connection()
 	: m_dbPtr(nullptr)
+	, m_readOnly(false)
+	, m_trackExternalChanges(false)
+	, m_changeGeneration(1)
+	, m_lastTotalChanges(0)
+	, m_lastDataVersion(0)
+	, m_dataVersionSupport(DataVersionUnknown)
 {
 	m_transactionResources.reset(new TransactionsResources(this));
 }
 
-dbc::Connection::Connection(const std::string& dbPath, bool create)
+dbc::Connection::Connection(const std::string& dbPath, bool create, bool readOnly)
 	: m_dbPtr(nullptr)
+	, m_readOnly(readOnly)
+	, m_trackExternalChanges(false)
+	, m_changeGeneration(1)
+	, m_lastTotalChanges(0)
+	, m_lastDataVersion(0)
+	, m_dataVersionSupport(DataVersionUnknown)
 {
 	if (create && dbc::utils::FileExists(dbPath))
 	{
@@ -41,6 +53,7 @@ void dbc::Connection::Reconnect(const std::string& dbPath)
 void dbc::Connection::Disconnect()
 {
 	int retCode = SQLITE_OK;
+	m_statements.Reset(nullptr);
 	if (m_dbPtr)
 	{
 		retCode = sqlite3_close(m_dbPtr);
@@ -85,6 +98,66 @@ sqlite3* dbc::Connection::GetDB()
 	return m_dbPtr;
 }
 
+bool dbc::Connection::InTransaction()
+{
+	CheckDB();
+
+	return sqlite3_get_autocommit(m_dbPtr) == 0;
+}
+
+uint64_t dbc::Connection::ChangeGeneration()
+{
+	if (InTransaction())
+	{
+		return 0;
+	}
+
+	int64_t dataVersion = 0;
+	if (m_trackExternalChanges)
+	{
+		if (m_dataVersionSupport == DataVersionUnsupported)
+		{
+			return 0;
+		}
+		// SQLite before 3.8.4 ignores the unknown pragma, the generation is always unknown then
+		SQLQuery query(*this, "PRAGMA data_version;");
+		if (!query.Step())
+		{
+			m_dataVersionSupport = DataVersionUnsupported;
+			return 0;
+		}
+		m_dataVersionSupport = DataVersionSupported;
+		dataVersion = query.ColumnInt64(0);
+	}
+
+	MutexLock lock(m_generationMutex);
+	int totalChanges = sqlite3_total_changes(m_dbPtr);
+	if (totalChanges != m_lastTotalChanges || dataVersion != m_lastDataVersion)
+	{
+		m_lastTotalChanges = totalChanges;
+		m_lastDataVersion = dataVersion;
+		++m_changeGeneration;
+	}
+	return m_changeGeneration;
+}
+
+void dbc::Connection::SetTrackExternalChanges(bool enabled)
+{
+	m_trackExternalChanges = enabled;
+}
+
+uint64_t dbc::Connection::RollbacksCount()
+{
+	CheckDB();
+
+	return m_transactionResources->Rollbacks();
+}
+
+dbc::StatementsCache& dbc::Connection::Statements()
+{
+	return m_statements;
+}
+
 dbc::Error dbc::Connection::ConvertToDBCErr(int sqlite_err_code)
 {
 	switch (sqlite_err_code)
@@ -122,7 +195,8 @@ dbc::Error dbc::Connection::ConvertToDBCErr(int sqlite_err_code)
 
 void dbc::Connection::Connect(const std::string &db_path)
 {
-	int retCode = sqlite3_open_v2(db_path.c_str(), &m_dbPtr, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_PRIVATECACHE, NULL);
+	int flags = m_readOnly ? SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
+	int retCode = sqlite3_open_v2(db_path.c_str(), &m_dbPtr, flags | SQLITE_OPEN_PRIVATECACHE, NULL);
 
 	std::stringstream ss;
 	ss << "\n++ Connection opened: DBfile \"" << db_path << "\", returned code = " << retCode;
@@ -132,6 +206,14 @@ void dbc::Connection::Connect(const std::string &db_path)
 	{
 		throw ContainerException(ERR_DB, CANT_OPEN, ConvertToDBCErr(retCode));
 	}
+	m_statements.Reset(m_dbPtr);
+
+	// The counters of the new handle start from scratch
+	MutexLock lock(m_generationMutex);
+	m_lastTotalChanges = 0;
+	m_lastDataVersion = 0;
+	m_dataVersionSupport = DataVersionUnknown;
+	++m_changeGeneration;
 }
 
 void dbc::Connection::CheckDB()
@@ -1,6 +1,7 @@
 #pragma once
 #include "TransactionGuard.h"
 #include "SQLQuery.h"
+#include "StatementsCache.h"
 
 struct sqlite3;
 
@@ -10,7 +11,7 @@ namespace dbc
 	{
 	public:
 		Connection();
-		Connection(const std::string& dbPath, bool create);
+		Connection(const std::string& dbPath, bool create, bool readOnly = false);
 		~Connection();
 
 		void Reconnect(const std::string& dbPath);
@@ -21,6 +22,14 @@ namespace dbc
 		SQLQuery CreateQuery(const std::string& query = "");
 
 		sqlite3* GetDB();
+		bool InTransaction(); // Explicit transaction or savepoint is opened
+		// Changes after every write of this connection and, if it is enabled, after the commits of the other connections.
+		// Returns 0 (unknown) while a transaction is opened: the uncommitted changes may be rolled back. It is also unknown
+		// if the external changes are tracked, but SQLite doesn't support PRAGMA data_version.
+		uint64_t ChangeGeneration();
+		void SetTrackExternalChanges(bool enabled);
+		uint64_t RollbacksCount(); // Savepoints rolled back by TransactionGuard, the in-memory indexes reload themselves after them
+		StatementsCache& Statements();
 
 		static Error ConvertToDBCErr(int sqliteErrCode);
 
@@ -30,6 +39,16 @@ namespace dbc
 
 	private:
 		sqlite3* m_dbPtr;
+		bool m_readOnly;
+		StatementsCache m_statements; // Must be cleared before m_dbPtr is closed
+
+		enum DataVersionSupport { DataVersionUnknown, DataVersionSupported, DataVersionUnsupported };
+		std::mutex m_generationMutex;
+		bool m_trackExternalChanges;
+		uint64_t m_changeGeneration;
+		int m_lastTotalChanges;
+		int64_t m_lastDataVersion;
+		DataVersionSupport m_dataVersionSupport;
 		TransactionsResourcesGuard m_transactionResources;
 	};
 
@@ -0,0 +1,156 @@
+#include "stdafx.h"
+#include "ConnectionOptions.h"
+#include "StatementsCache.h"
+#include "DentryCache.h"
+
+namespace
+{
+	const unsigned int s_defaultVacuumStepPages = 64;
+}
+
+dbc::ConnectionOptions::ConnectionOptions(TuningProfile profile)
+	: m_journalMode(DbJournalModeDelete)
+	, m_synchronous(DbSynchronousFull)
+	, m_cacheSizeKb(2000) // SQLite default
+	, m_mmapSize(0)
+	, m_tempStore(DbTempStoreDefault)
+	, m_incrementalVacuum(true)
+	, m_vacuumStepPages(s_defaultVacuumStepPages)
+	, m_statementsCacheSize(StatementsCache::DEFAULT_CAPACITY)
+	, m_readConnectionsCount(0)
+	, m_dentryCacheSize(DentryCache::DEFAULT_CAPACITY)
+	, m_trackExternalChanges(false)
+{
+	switch (profile)
+	{
+	case TuningProfileCompatible:
+		break;
+	case TuningProfileBalanced:
+		m_journalMode = DbJournalModeWal;
+		m_synchronous = DbSynchronousNormal;
+		m_cacheSizeKb = 16 * 1024;
+		m_mmapSize = 64 * 1024 * 1024;
+		m_tempStore = DbTempStoreMemory;
+		break;
+	case TuningProfileThroughput:
+		m_journalMode = DbJournalModeWal;
+		m_synchronous = DbSynchronousOff;
+		m_cacheSizeKb = 64 * 1024;
+		m_mmapSize = 256 * 1024 * 1024;
+		m_tempStore = DbTempStoreMemory;
+		m_statementsCacheSize = StatementsCache::DEFAULT_CAPACITY * 4;
+		break;
+	default:
+		assert(!"Unknown tuning profile");
+	}
+}
+
+dbc::DbJournalMode dbc::ConnectionOptions::JournalMode() const
+{
+	return m_journalMode;
+}
+
+dbc::DbSynchronousMode dbc::ConnectionOptions::Synchronous() const
+{
+	return m_synchronous;
+}
+
+unsigned int dbc::ConnectionOptions::CacheSizeKb() const
+{
+	return m_cacheSizeKb;
+}
+
+uint64_t dbc::ConnectionOptions::MmapSize() const
+{
+	return m_mmapSize;
+}
+
+dbc::DbTempStore dbc::ConnectionOptions::TempStore() const
+{
+	return m_tempStore;
+}
+
+bool dbc::ConnectionOptions::IncrementalVacuum() const
+{
+	return m_incrementalVacuum;
+}
+
+unsigned int dbc::ConnectionOptions::VacuumStepPages() const
+{
+	return m_vacuumStepPages;
+}
+
+size_t dbc::ConnectionOptions::StatementsCacheSize() const
+{
+	return m_statementsCacheSize;
+}
+
+size_t dbc::ConnectionOptions::ReadConnectionsCount() const
+{
+	return m_readConnectionsCount;
+}
+
+size_t dbc::ConnectionOptions::DentryCacheSize() const
+{
+	return m_dentryCacheSize;
+}
+
+bool dbc::ConnectionOptions::TrackExternalChanges() const
+{
+	return m_trackExternalChanges;
+}
+
+void dbc::ConnectionOptions::SetJournalMode(DbJournalMode mode)
+{
+	m_journalMode = mode;
+}
+
+void dbc::ConnectionOptions::SetSynchronous(DbSynchronousMode mode)
+{
+	m_synchronous = mode;
+}
+
+void dbc::ConnectionOptions::SetCacheSizeKb(unsigned int size)
+{
+	m_cacheSizeKb = size;
+}
+
+void dbc::ConnectionOptions::SetMmapSize(uint64_t size)
+{
+	m_mmapSize = size;
+}
+
+void dbc::ConnectionOptions::SetTempStore(DbTempStore store)
+{
+	m_tempStore = store;
+}
+
+void dbc::ConnectionOptions::SetIncrementalVacuum(bool enabled)
+{
+	m_incrementalVacuum = enabled;
+}
+
+void dbc::ConnectionOptions::SetVacuumStepPages(unsigned int pages)
+{
+	m_vacuumStepPages = pages > 0 ? pages : 1;
+}
+
+void dbc::ConnectionOptions::SetStatementsCacheSize(size_t size)
+{
+	m_statementsCacheSize = size;
+}
+
+void dbc::ConnectionOptions::SetReadConnectionsCount(size_t count)
+{
+	m_readConnectionsCount = count;
+}
+
+void dbc::ConnectionOptions::SetDentryCacheSize(size_t size)
+{
+	m_dentryCacheSize = size;
+}
+
+void dbc::ConnectionOptions::SetTrackExternalChanges(bool enabled)
+{
+	m_trackExternalChanges = enabled;
+}
@@ -8,6 +8,7 @@
 #include "ContainerInfoImpl.h"
 #include "CommonUtils.h"
 #include "FsUtils.h"
+#include "Logging.h"
 
 const int dbc::Container::ROOT_ID = 1;
 
@@ -17,7 +18,7 @@ namespace
 {
 	void ClearDB(Connection& connection)
 	{
-        std::string tables[] = { "Sets", "FileSystem", "FileStreams" };
+        std::string tables[] = { "Sets", "FileSystem", "FileStreams", "FileSystemTree", "FolderAggregates", "ElementsMeta", "InlineData", "TailBlocks", "FileTails", "TuningDecisions" };
 		dbc::SQLQuery query = connection.CreateQuery();
 		std::string dropCommand("DROP TABLE ");
         for (const std::string& table : tables)
@@ -70,15 +71,424 @@ namespace
 
 	void WriteSets(Connection& connection)
 	{
-		//SQLQuery query(db, L"INSERT INTO Sets(path_sep) VALUES (?);");
+		SQLQuery query(connection, "INSERT INTO Sets(id) VALUES (1);");
+		query.Step();
 		// TODO: Write another sets
 	}
 
+	bool ColumnExists(Connection& connection, const std::string& table, const std::string& column)
+	{
+		bool exists = false;
+		SQLQuery query(connection, "PRAGMA table_info(" + table + ");");
+		while (query.Step())
+		{
+			std::string columnName;
+			query.ColumnText(1, columnName);
+			exists = exists || columnName == column;
+		}
+		return exists;
+	}
+
+	// Schema versions. Version 0 is the original schema without secondary indexes and without the schema version in Sets.
+	// Every upgrade function moves the schema from the version equal to its index in s_schemaUpgrades to the next one.
+	void UpgradeSchemaTo1(Connection& connection)
+	{
+		std::list<std::string> queries;
+		queries.push_back("ALTER TABLE Sets ADD COLUMN schema_version INTEGER NOT NULL DEFAULT 0;");
+		queries.push_back("INSERT OR IGNORE INTO Sets(id) VALUES (1);");
+		// Path walking, GetChild(), Exists() and children listing. Also guarantees unique names inside the folder.
+		queries.push_back("CREATE UNIQUE INDEX IF NOT EXISTS idx_FileSystem_parent_name ON FileSystem(parent_id, name);");
+		// Covering index for the streams chain of the file and for its SUM(used)
+		queries.push_back("CREATE INDEX IF NOT EXISTS idx_FileStreams_file_order ON FileStreams(file_id, stream_order, start, size, used);");
+		// Covering index for the free streams lookups of FileStreamsAllocator
+		queries.push_back("CREATE INDEX IF NOT EXISTS idx_FileStreams_used_size ON FileStreams(used, size, file_id, stream_order, start);");
+
+		SQLQuery query(connection);
+		for (const std::string& upgradeQuery : queries)
+		{
+			query.Prepare(upgradeQuery);
+			query.Step();
+		}
+	}
+
+	// Closure table of FileSystem: every element is linked with itself (depth 0) and with all its ancestors.
+	// It is maintained by the triggers, so Path(), IsChildOf() and the subtree queries don't walk the parents chain.
+	void UpgradeSchemaTo2(Connection& connection)
+	{
+		std::list<std::string> queries;
+		queries.push_back("CREATE TABLE FileSystemTree(ancestor_id INTEGER NOT NULL, descendant_id INTEGER NOT NULL, depth INTEGER NOT NULL, PRIMARY KEY(ancestor_id, descendant_id));");
+		queries.push_back("CREATE INDEX idx_FileSystemTree_descendant ON FileSystemTree(descendant_id, depth, ancestor_id);");
+		queries.push_back("CREATE TRIGGER trg_FileSystem_insert AFTER INSERT ON FileSystem BEGIN "
+			"INSERT INTO FileSystemTree(ancestor_id, descendant_id, depth) SELECT ancestor_id, NEW.id, depth + 1 FROM FileSystemTree WHERE descendant_id = NEW.parent_id; "
+			"INSERT INTO FileSystemTree(ancestor_id, descendant_id, depth) VALUES (NEW.id, NEW.id, 0); "
+			"END;");
+		queries.push_back("CREATE TRIGGER trg_FileSystem_delete AFTER DELETE ON FileSystem BEGIN "
+			"DELETE FROM FileSystemTree WHERE descendant_id = OLD.id; "
+			"DELETE FROM FileSystemTree WHERE ancestor_id = OLD.id; "
+			"END;");
+		// Links between the moved subtree and its old ancestors are replaced with the links to the new ones
+		queries.push_back("CREATE TRIGGER trg_FileSystem_move AFTER UPDATE OF parent_id ON FileSystem WHEN OLD.parent_id != NEW.parent_id BEGIN "
+			"DELETE FROM FileSystemTree WHERE descendant_id IN (SELECT descendant_id FROM FileSystemTree WHERE ancestor_id = NEW.id) "
+			"AND ancestor_id IN (SELECT ancestor_id FROM FileSystemTree WHERE descendant_id = NEW.id AND ancestor_id != NEW.id); "
+			"INSERT INTO FileSystemTree(ancestor_id, descendant_id, depth) SELECT ancestors.ancestor_id, subtree.descendant_id, ancestors.depth + subtree.depth + 1 "
+			"FROM FileSystemTree AS ancestors, FileSystemTree AS subtree WHERE ancestors.descendant_id = NEW.parent_id AND subtree.ancestor_id = NEW.id; "
+			"END;");
+		// Existing elements: self links, then the links of every next depth are built from the previous one
+		queries.push_back("INSERT INTO FileSystemTree(ancestor_id, descendant_id, depth) SELECT id, id, 0 FROM FileSystem;");
+
+		SQLQuery query(connection);
+		for (const std::string& upgradeQuery : queries)
+		{
+			query.Prepare(upgradeQuery);
+			query.Step();
+		}
+
+		// OR IGNORE stops the loop on the damaged tree with a cycle
+		query.Prepare("INSERT OR IGNORE INTO FileSystemTree(ancestor_id, descendant_id, depth) SELECT FileSystemTree.ancestor_id, FileSystem.id, ? "
+			"FROM FileSystemTree JOIN FileSystem ON FileSystem.parent_id = FileSystemTree.descendant_id WHERE FileSystemTree.depth = ?;");
+		for (int depth = 0; ; ++depth, query.Reset())
+		{
+			query.BindInt(1, depth + 1);
+			query.BindInt(2, depth);
+			query.Step();
+			if (query.Changes() == 0)
+			{
+				break;
+			}
+		}
+	}
+
+	// Children listings filtered by ListFilter. The name conditions use idx_FileSystem_parent_name.
+	void UpgradeSchemaTo3(Connection& connection)
+	{
+		std::list<std::string> queries;
+		queries.push_back("CREATE INDEX IF NOT EXISTS idx_FileSystem_parent_type ON FileSystem(parent_id, type, name);");
+		queries.push_back("CREATE INDEX IF NOT EXISTS idx_FileSystem_parent_modified ON FileSystem(parent_id, modified, name);");
+		queries.push_back("CREATE INDEX IF NOT EXISTS idx_FileSystem_parent_created ON FileSystem(parent_id, created, name);");
+
+		SQLQuery query(connection);
+		for (const std::string& upgradeQuery : queries)
+		{
+			query.Prepare(upgradeQuery);
+			query.Step();
+		}
+	}
+
+	// Aggregates of every folder's subtree: the number of direct children and of all descendants and the bytes used by the files.
+	// The triggers of FileSystem are replaced with ones which also maintain them, so the statements are executed in a known order:
+	// the ancestors of the element are found by FileSystemTree before its links are removed and after they are created.
+	// The subtree of the moved element is counted by its own aggregates (folders) or streams (files).
+	void UpgradeSchemaTo4(Connection& connection)
+	{
+		const std::string ancestorsOfNew = "(SELECT ancestor_id FROM FileSystemTree WHERE descendant_id = NEW.id AND depth > 0)";
+		const std::string ancestorsOfOld = "(SELECT ancestor_id FROM FileSystemTree WHERE descendant_id = OLD.id AND depth > 0)";
+		const std::string movedCount = "(1 + IFNULL((SELECT descendants FROM FolderAggregates WHERE folder_id = NEW.id), 0))";
+		const std::string movedSize = "(IFNULL((SELECT total_size FROM FolderAggregates WHERE folder_id = NEW.id), 0) + "
+			"(SELECT IFNULL(SUM(used), 0) FROM FileStreams WHERE file_id = NEW.id))";
+
+		std::list<std::string> queries;
+		queries.push_back("CREATE TABLE FolderAggregates(folder_id INTEGER PRIMARY KEY NOT NULL, children INTEGER NOT NULL DEFAULT 0, "
+			"descendants INTEGER NOT NULL DEFAULT 0, total_size INTEGER NOT NULL DEFAULT 0);");
+		queries.push_back("DROP TRIGGER trg_FileSystem_insert;");
+		queries.push_back("DROP TRIGGER trg_FileSystem_delete;");
+		queries.push_back("DROP TRIGGER trg_FileSystem_move;");
+		// 1 is ElementTypeFolder
+		queries.push_back("CREATE TRIGGER trg_FileSystem_insert AFTER INSERT ON FileSystem BEGIN "
+			"INSERT INTO FileSystemTree(ancestor_id, descendant_id, depth) SELECT ancestor_id, NEW.id, depth + 1 FROM FileSystemTree WHERE descendant_id = NEW.parent_id; "
+			"INSERT INTO FileSystemTree(ancestor_id, descendant_id, depth) VALUES (NEW.id, NEW.id, 0); "
+			"UPDATE FolderAggregates SET descendants = descendants + 1 WHERE folder_id IN " + ancestorsOfNew + "; "
+			"UPDATE FolderAggregates SET children = children + 1 WHERE folder_id = NEW.parent_id; "
+			"INSERT INTO FolderAggregates(folder_id) SELECT NEW.id WHERE NEW.type = 1; "
+			"END;");
+		// Folder::Remove() subtracts the whole subtree from the ancestors and removes its links before the elements
+		queries.push_back("CREATE TRIGGER trg_FileSystem_delete AFTER DELETE ON FileSystem BEGIN "
+			"UPDATE FolderAggregates SET descendants = descendants - 1, "
+			"total_size = total_size - (SELECT IFNULL(SUM(used), 0) FROM FileStreams WHERE file_id = OLD.id) WHERE folder_id IN " + ancestorsOfOld + "; "
+			"UPDATE FolderAggregates SET children = children - 1 WHERE folder_id = OLD.parent_id; "
+			"DELETE FROM FolderAggregates WHERE folder_id = OLD.id; "
+			"DELETE FROM FileSystemTree WHERE descendant_id = OLD.id; "
+			"DELETE FROM FileSystemTree WHERE ancestor_id = OLD.id; "
+			"END;");
+		queries.push_back("CREATE TRIGGER trg_FileSystem_move AFTER UPDATE OF parent_id ON FileSystem WHEN OLD.parent_id != NEW.parent_id BEGIN "
+			"UPDATE FolderAggregates SET children = children - 1 WHERE folder_id = OLD.parent_id; "
+			"UPDATE FolderAggregates SET children = children + 1 WHERE folder_id = NEW.parent_id; "
+			"UPDATE FolderAggregates SET descendants = descendants - " + movedCount + ", total_size = total_size - " + movedSize + " WHERE folder_id IN " + ancestorsOfNew + "; "
+			"DELETE FROM FileSystemTree WHERE descendant_id IN (SELECT descendant_id FROM FileSystemTree WHERE ancestor_id = NEW.id) "
+			"AND ancestor_id IN (SELECT ancestor_id FROM FileSystemTree WHERE descendant_id = NEW.id AND ancestor_id != NEW.id); "
+			"INSERT INTO FileSystemTree(ancestor_id, descendant_id, depth) SELECT ancestors.ancestor_id, subtree.descendant_id, ancestors.depth + subtree.depth + 1 "
+			"FROM FileSystemTree AS ancestors, FileSystemTree AS subtree WHERE ancestors.descendant_id = NEW.parent_id AND subtree.ancestor_id = NEW.id; "
+			"UPDATE FolderAggregates SET descendants = descendants + " + movedCount + ", total_size = total_size + " + movedSize + " WHERE folder_id IN " + ancestorsOfNew + "; "
+			"END;");
+		queries.push_back("CREATE TRIGGER trg_FileStreams_insert AFTER INSERT ON FileStreams WHEN NEW.used != 0 BEGIN "
+			"UPDATE FolderAggregates SET total_size = total_size + NEW.used WHERE folder_id IN "
+			"(SELECT ancestor_id FROM FileSystemTree WHERE descendant_id = NEW.file_id AND depth > 0); "
+			"END;");
+		queries.push_back("CREATE TRIGGER trg_FileStreams_delete AFTER DELETE ON FileStreams WHEN OLD.used != 0 BEGIN "
+			"UPDATE FolderAggregates SET total_size = total_size - OLD.used WHERE folder_id IN "
+			"(SELECT ancestor_id FROM FileSystemTree WHERE descendant_id = OLD.file_id AND depth > 0); "
+			"END;");
+		queries.push_back("CREATE TRIGGER trg_FileStreams_update AFTER UPDATE OF file_id, used ON FileStreams "
+			"WHEN OLD.used != NEW.used OR OLD.file_id != NEW.file_id BEGIN "
+			"UPDATE FolderAggregates SET total_size = total_size - OLD.used WHERE folder_id IN "
+			"(SELECT ancestor_id FROM FileSystemTree WHERE descendant_id = OLD.file_id AND depth > 0); "
+			"UPDATE FolderAggregates SET total_size = total_size + NEW.used WHERE folder_id IN "
+			"(SELECT ancestor_id FROM FileSystemTree WHERE descendant_id = NEW.file_id AND depth > 0); "
+			"END;");
+		// Existing folders
+		queries.push_back("INSERT INTO FolderAggregates(folder_id, children, descendants, total_size) SELECT id, "
+			"(SELECT count(*) FROM FileSystem AS children WHERE children.parent_id = folders.id), "
+			"(SELECT count(*) FROM FileSystemTree WHERE ancestor_id = folders.id AND depth > 0), "
+			"(SELECT IFNULL(SUM(FileStreams.used), 0) FROM FileSystemTree JOIN FileStreams ON FileStreams.file_id = FileSystemTree.descendant_id "
+			"WHERE FileSystemTree.ancestor_id = folders.id) "
+			"FROM FileSystem AS folders WHERE type = 1;");
+
+		SQLQuery query(connection);
+		for (const std::string& upgradeQuery : queries)
+		{
+			query.Prepare(upgradeQuery);
+			query.Step();
+		}
+	}
+
+	// Bytes used by the file are stored in its FileSystem row, so File::Size() and the listings don't read FileStreams.
+	// The FileStreams triggers are recreated to update it together with the folder aggregates.
+	void UpgradeSchemaTo5(Connection& connection)
+	{
+		std::list<std::string> queries;
+		if (!ColumnExists(connection, "FileSystem", "data_size")) // SQLite can't drop columns, it may be left by a downgrade
+		{
+			queries.push_back("ALTER TABLE FileSystem ADD COLUMN data_size INTEGER NOT NULL DEFAULT 0;");
+		}
+		queries.push_back("UPDATE FileSystem SET data_size = (SELECT IFNULL(SUM(used), 0) FROM FileStreams WHERE file_id = FileSystem.id) WHERE type = 2;");
+		queries.push_back("DROP TRIGGER trg_FileStreams_insert;");
+		queries.push_back("DROP TRIGGER trg_FileStreams_delete;");
+		queries.push_back("DROP TRIGGER trg_FileStreams_update;");
+		queries.push_back("CREATE TRIGGER trg_FileStreams_insert AFTER INSERT ON FileStreams WHEN NEW.used != 0 BEGIN "
+			"UPDATE FileSystem SET data_size = data_size + NEW.used WHERE id = NEW.file_id; "
+			"UPDATE FolderAggregates SET total_size = total_size + NEW.used WHERE folder_id IN "
+			"(SELECT ancestor_id FROM FileSystemTree WHERE descendant_id = NEW.file_id AND depth > 0); "
+			"END;");
+		queries.push_back("CREATE TRIGGER trg_FileStreams_delete AFTER DELETE ON FileStreams WHEN OLD.used != 0 BEGIN "
+			"UPDATE FileSystem SET data_size = data_size - OLD.used WHERE id = OLD.file_id; "
+			"UPDATE FolderAggregates SET total_size = total_size - OLD.used WHERE folder_id IN "
+			"(SELECT ancestor_id FROM FileSystemTree WHERE descendant_id = OLD.file_id AND depth > 0); "
+			"END;");
+		queries.push_back("CREATE TRIGGER trg_FileStreams_update AFTER UPDATE OF file_id, used ON FileStreams "
+			"WHEN OLD.used != NEW.used OR OLD.file_id != NEW.file_id BEGIN "
+			"UPDATE FileSystem SET data_size = data_size - OLD.used WHERE id = OLD.file_id; "
+			"UPDATE FileSystem SET data_size = data_size + NEW.used WHERE id = NEW.file_id; "
+			"UPDATE FolderAggregates SET total_size = total_size - OLD.used WHERE folder_id IN "
+			"(SELECT ancestor_id FROM FileSystemTree WHERE descendant_id = OLD.file_id AND depth > 0); "
+			"UPDATE FolderAggregates SET total_size = total_size + NEW.used WHERE folder_id IN "
+			"(SELECT ancestor_id FROM FileSystemTree WHERE descendant_id = NEW.file_id AND depth > 0); "
+			"END;");
+
+		SQLQuery query(connection);
+		for (const std::string& upgradeQuery : queries)
+		{
+			query.Prepare(upgradeQuery);
+			query.Step();
+		}
+	}
+
+	// The meta of the folders and files may be up to ElementProperties::s_MaxTagLength, so it is moved out of the FileSystem rows
+	// into ElementsMeta, which is read only by GetProperties(). The targets of the links are moved into the new column.
+	// FileSystem.meta can't be dropped, it is left empty. The queries are repeatable, the schema version may be downgraded.
+	void UpgradeSchemaTo6(Connection& connection)
+	{
+		std::list<std::string> queries;
+		if (!ColumnExists(connection, "FileSystem", "target"))
+		{
+			queries.push_back("ALTER TABLE FileSystem ADD COLUMN target TEXT;");
+		}
+		queries.push_back("CREATE TABLE IF NOT EXISTS ElementsMeta(element_id INTEGER PRIMARY KEY NOT NULL, meta TEXT NOT NULL);");
+		// 3 and 4 are ElementTypeSymLink and ElementTypeDirectLink
+		queries.push_back("UPDATE FileSystem SET target = meta WHERE type IN (3, 4) AND meta IS NOT NULL;");
+		queries.push_back("INSERT OR REPLACE INTO ElementsMeta(element_id, meta) SELECT id, meta FROM FileSystem "
+			"WHERE type NOT IN (3, 4) AND meta IS NOT NULL AND meta != '';");
+		queries.push_back("UPDATE FileSystem SET meta = NULL WHERE meta IS NOT NULL;");
+		queries.push_back("CREATE TRIGGER IF NOT EXISTS trg_FileSystem_delete_meta AFTER DELETE ON FileSystem BEGIN "
+			"DELETE FROM ElementsMeta WHERE element_id = OLD.id; "
+			"END;");
+
+		SQLQuery query(connection);
+		for (const std::string& upgradeQuery : queries)
+		{
+			query.Prepare(upgradeQuery);
+			query.Step();
+		}
+	}
+
+	// The data of the small files is stored encrypted in InlineData instead of the streams, see DataUsagePreferences::InlineDataThreshold().
+	// Its triggers update FileSystem.data_size and the folder aggregates as the FileStreams triggers do,
+	// so the moved files are counted by their data_size instead of their streams. The queries are repeatable.
+	void UpgradeSchemaTo7(Connection& connection)
+	{
+		const std::string ancestorsOfNew = "(SELECT ancestor_id FROM FileSystemTree WHERE descendant_id = NEW.id AND depth > 0)";
+		const std::string movedCount = "(1 + IFNULL((SELECT descendants FROM FolderAggregates WHERE folder_id = NEW.id), 0))";
+		const std::string movedSize = "(IFNULL((SELECT total_size FROM FolderAggregates WHERE folder_id = NEW.id), 0) + NEW.data_size)";
+
+		std::list<std::string> queries;
+		queries.push_back("CREATE TABLE IF NOT EXISTS InlineData(file_id INTEGER PRIMARY KEY NOT NULL, size INTEGER NOT NULL, data BLOB NOT NULL);");
+		queries.push_back("CREATE TRIGGER IF NOT EXISTS trg_InlineData_insert AFTER INSERT ON InlineData BEGIN "
+			"UPDATE FileSystem SET data_size = data_size + NEW.size WHERE id = NEW.file_id; "
+			"UPDATE FolderAggregates SET total_size = total_size + NEW.size WHERE folder_id IN "
+			"(SELECT ancestor_id FROM FileSystemTree WHERE descendant_id = NEW.file_id AND depth > 0); "
+			"END;");
+		queries.push_back("CREATE TRIGGER IF NOT EXISTS trg_InlineData_delete AFTER DELETE ON InlineData BEGIN "
+			"UPDATE FileSystem SET data_size = data_size - OLD.size WHERE id = OLD.file_id; "
+			"UPDATE FolderAggregates SET total_size = total_size - OLD.size WHERE folder_id IN "
+			"(SELECT ancestor_id FROM FileSystemTree WHERE descendant_id = OLD.file_id AND depth > 0); "
+			"END;");
+		// File::Remove() removes the inline data before the file, Folder::Remove() removes the links of the subtree before the elements
+		queries.push_back("CREATE TRIGGER IF NOT EXISTS trg_FileSystem_delete_inline AFTER DELETE ON FileSystem BEGIN "
+			"DELETE FROM InlineData WHERE file_id = OLD.id; "
+			"END;");
+		queries.push_back("DROP TRIGGER IF EXISTS trg_FileSystem_move;");
+		queries.push_back("CREATE TRIGGER trg_FileSystem_move AFTER UPDATE OF parent_id ON FileSystem WHEN OLD.parent_id != NEW.parent_id BEGIN "
+			"UPDATE FolderAggregates SET children = children - 1 WHERE folder_id = OLD.parent_id; "
+			"UPDATE FolderAggregates SET children = children + 1 WHERE folder_id = NEW.parent_id; "
+			"UPDATE FolderAggregates SET descendants = descendants - " + movedCount + ", total_size = total_size - " + movedSize + " WHERE folder_id IN " + ancestorsOfNew + "; "
+			"DELETE FROM FileSystemTree WHERE descendant_id IN (SELECT descendant_id FROM FileSystemTree WHERE ancestor_id = NEW.id) "
+			"AND ancestor_id IN (SELECT ancestor_id FROM FileSystemTree WHERE descendant_id = NEW.id AND ancestor_id != NEW.id); "
+			"INSERT INTO FileSystemTree(ancestor_id, descendant_id, depth) SELECT ancestors.ancestor_id, subtree.descendant_id, ancestors.depth + subtree.depth + 1 "
+			"FROM FileSystemTree AS ancestors, FileSystemTree AS subtree WHERE ancestors.descendant_id = NEW.parent_id AND subtree.ancestor_id = NEW.id; "
+			"UPDATE FolderAggregates SET descendants = descendants + " + movedCount + ", total_size = total_size + " + movedSize + " WHERE folder_id IN " + ancestorsOfNew + "; "
+			"END;");
+		// The sizes might be counted only by the streams by the previous upgrades
+		queries.push_back("UPDATE FileSystem SET data_size = (SELECT IFNULL(SUM(used), 0) FROM FileStreams WHERE file_id = FileSystem.id) + "
+			"IFNULL((SELECT size FROM InlineData WHERE file_id = FileSystem.id), 0) WHERE type = 2;");
+		queries.push_back("UPDATE FolderAggregates SET total_size = (SELECT IFNULL(SUM(FileSystem.data_size), 0) FROM FileSystemTree "
+			"JOIN FileSystem ON FileSystem.id = FileSystemTree.descendant_id WHERE FileSystemTree.ancestor_id = FolderAggregates.folder_id);");
+
+		SQLQuery query(connection);
+		for (const std::string& upgradeQuery : queries)
+		{
+			query.Prepare(upgradeQuery);
+			query.Step();
+		}
+	}
+
+	// Tail packing, see DataUsagePreferences::TailPacking(). TailBlocks are the extents of the binary storage shared by the tails,
+	// FileTails are the last partial clusters of the files at their offsets in the blocks. The queries are repeatable.
+	void UpgradeSchemaTo8(Connection& connection)
+	{
+		std::list<std::string> queries;
+		queries.push_back("CREATE TABLE IF NOT EXISTS TailBlocks(id INTEGER PRIMARY KEY NOT NULL, start INTEGER NOT NULL, size INTEGER NOT NULL);");
+		queries.push_back("CREATE TABLE IF NOT EXISTS FileTails(file_id INTEGER PRIMARY KEY NOT NULL, block_id INTEGER NOT NULL, "
+			"offset INTEGER NOT NULL, size INTEGER NOT NULL);");
+		// The free gaps of the blocks are found between the neighbouring tails
+		queries.push_back("CREATE INDEX IF NOT EXISTS idx_FileTails_block_offset ON FileTails(block_id, offset, size);");
+		queries.push_back("CREATE TRIGGER IF NOT EXISTS trg_FileTails_insert AFTER INSERT ON FileTails BEGIN "
+			"UPDATE FileSystem SET data_size = data_size + NEW.size WHERE id = NEW.file_id; "
+			"UPDATE FolderAggregates SET total_size = total_size + NEW.size WHERE folder_id IN "
+			"(SELECT ancestor_id FROM FileSystemTree WHERE descendant_id = NEW.file_id AND depth > 0); "
+			"END;");
+		queries.push_back("CREATE TRIGGER IF NOT EXISTS trg_FileTails_delete AFTER DELETE ON FileTails BEGIN "
+			"UPDATE FileSystem SET data_size = data_size - OLD.size WHERE id = OLD.file_id; "
+			"UPDATE FolderAggregates SET total_size = total_size - OLD.size WHERE folder_id IN "
+			"(SELECT ancestor_id FROM FileSystemTree WHERE descendant_id = OLD.file_id AND depth > 0); "
+			"END;");
+		queries.push_back("CREATE TRIGGER IF NOT EXISTS trg_FileSystem_delete_tail AFTER DELETE ON FileSystem BEGIN "
+			"DELETE FROM FileTails WHERE file_id = OLD.id; "
+			"END;");
+		// The sizes might be counted without the tails by the previous upgrades
+		queries.push_back("UPDATE FileSystem SET data_size = (SELECT IFNULL(SUM(used), 0) FROM FileStreams WHERE file_id = FileSystem.id) + "
+			"IFNULL((SELECT size FROM InlineData WHERE file_id = FileSystem.id), 0) + "
+			"IFNULL((SELECT size FROM FileTails WHERE file_id = FileSystem.id), 0) WHERE type = 2;");
+		queries.push_back("UPDATE FolderAggregates SET total_size = (SELECT IFNULL(SUM(FileSystem.data_size), 0) FROM FileSystemTree "
+			"JOIN FileSystem ON FileSystem.id = FileSystemTree.descendant_id WHERE FileSystemTree.ancestor_id = FolderAggregates.folder_id);");
+
+		SQLQuery query(connection);
+		for (const std::string& upgradeQuery : queries)
+		{
+			query.Prepare(upgradeQuery);
+			query.Step();
+		}
+	}
+
+	// DataUsagePreferences are saved in Sets, the columns are NULL until they are saved. TuningDecisions is the log of the auto-tuning.
+	// The queries are repeatable.
+	void UpgradeSchemaTo9(Connection& connection)
+	{
+		const char* prefsColumns[] = { "cluster_size_level", "fragmentation_level", "transactional_write", "storage_growth",
+			"inline_data_threshold", "tail_packing", "adaptive_cluster_size", "auto_tune" };
+		std::list<std::string> queries;
+		for (const char* column : prefsColumns)
+		{
+			if (!ColumnExists(connection, "Sets", column))
+			{
+				queries.push_back(std::string("ALTER TABLE Sets ADD COLUMN ") + column + " INTEGER;");
+			}
+		}
+		queries.push_back("CREATE TABLE IF NOT EXISTS TuningDecisions(id INTEGER PRIMARY KEY NOT NULL, time INTEGER NOT NULL, samples INTEGER NOT NULL, "
+			"median_write_size INTEGER NOT NULL, average_streams REAL NOT NULL, waste_ratio REAL NOT NULL, "
+			"old_cluster_size_level INTEGER NOT NULL, new_cluster_size_level INTEGER NOT NULL, "
+			"old_tail_packing INTEGER NOT NULL, new_tail_packing INTEGER NOT NULL, reason TEXT NOT NULL);");
+
+		SQLQuery query(connection);
+		for (const std::string& upgradeQuery : queries)
+		{
+			query.Prepare(upgradeQuery);
+			query.Step();
+		}
+	}
+
+	typedef void(*SchemaUpgradeFn)(Connection& connection);
+	const SchemaUpgradeFn s_schemaUpgrades[] = { UpgradeSchemaTo1, UpgradeSchemaTo2, UpgradeSchemaTo3, UpgradeSchemaTo4, UpgradeSchemaTo5, UpgradeSchemaTo6, UpgradeSchemaTo7, UpgradeSchemaTo8, UpgradeSchemaTo9 };
+	const size_t s_maxTuningDecisions = 100;
+	const int s_schemaVersion = sizeof(s_schemaUpgrades) / sizeof(s_schemaUpgrades[0]);
+
+	int ReadSchemaVersion(Connection& connection)
+	{
+		if (!ColumnExists(connection, "Sets", "schema_version"))
+		{
+			return 0;
+		}
+
+		SQLQuery query(connection, "SELECT schema_version FROM Sets WHERE id = 1;");
+		return query.Step() ? query.ColumnInt(0) : 0;
+	}
+
+	void UpgradeSchema(Connection& connection)
+	{
+		int version = ReadSchemaVersion(connection);
+		if (version == s_schemaVersion)
+		{
+			return;
+		}
+		if (version > s_schemaVersion) // Container was created by the newer version of the library
+		{
+			throw ContainerException(ERR_DB, CANT_OPEN, ERR_DB, NOT_VALID);
+		}
+
+		try
+		{
+			TransactionGuard transaction = connection.StartTransaction();
+			for (; version < s_schemaVersion; ++version)
+			{
+				s_schemaUpgrades[version](connection);
+			}
+
+			SQLQuery query(connection, "UPDATE Sets SET schema_version = ? WHERE id = 1;");
+			query.BindInt(1, s_schemaVersion);
+			query.Step();
+			transaction->Commit();
+		}
+		catch (const ContainerException& ex)
+		{
+			WriteLog("Unable to upgrade the database schema: " + ex.FullMessage());
+			// F.e. the unique index can't be created if the folder already contains two children with the same name
+			throw ContainerException(ERR_DB, CANT_OPEN, ERR_DB, IS_DAMAGED);
+		}
+	}
+
 	void BuildDB(Connection& connection)
 	{
 		WriteTables(connection);
 		WriteRoot(connection);
 		WriteSets(connection);
+		UpgradeSchema(connection);
 	}
 
 	/*Error DBIsEmpty(sqlite3 * db)
@@ -115,21 +525,78 @@ namespace
 		// TODO: implement proper DB validation
 	}
 
-	void SetDBPragma(dbc::Connection &db)
+	void SetDBPragma(dbc::Connection &db, const ConnectionOptions& options)
+	{
+		static const char* s_journalModes[] = { "DELETE", "TRUNCATE", "PERSIST", "WAL" };
+		static const char* s_synchronousModes[] = { "OFF", "NORMAL", "FULL" };
+
+		std::stringstream pragmas;
+		// Switching between FULL and INCREMENTAL is allowed at any time. It takes effect for the containers
+		// without auto-vacuum only if it was set before the tables were created.
+		pragmas << "PRAGMA auto_vacuum = " << (options.IncrementalVacuum() ? "INCREMENTAL" : "FULL") << ";";
+		pragmas << "PRAGMA journal_mode = " << s_journalModes[options.JournalMode()] << ";";
+		pragmas << "PRAGMA synchronous = " << s_synchronousModes[options.Synchronous()] << ";";
+		pragmas << "PRAGMA cache_size = -" << options.CacheSizeKb() << ";"; // negative value is the size in KiB
+		pragmas << "PRAGMA mmap_size = " << options.MmapSize() << ";";
+		pragmas << "PRAGMA temp_store = " << static_cast<int>(options.TempStore()) << ";";
+		db.ExecQuery(pragmas.str());
+
+		db.Statements().SetCapacity(options.StatementsCacheSize());
+		db.SetTrackExternalChanges(options.TrackExternalChanges());
+	}
+
+	// Readers block the writer in the rollback journal modes, so the read connections are used only with WAL
+	size_t ReadConnectionsCapacity(Connection& connection, const ConnectionOptions& options)
 	{
-		dbc::SQLQuery query(db, "PRAGMA auto_vacuum = FULL;");
+		SQLQuery query(connection, "PRAGMA journal_mode;");
 		query.Step();
+		std::string journalMode;
+		query.ColumnText(0, journalMode);
+		if (journalMode != "wal")
+		{
+			return 0;
+		}
+
+		if (options.ReadConnectionsCount() != 0)
+		{
+			return options.ReadConnectionsCount();
+		}
+		unsigned int cores = std::thread::hardware_concurrency();
+		return cores != 0 ? cores : 2;
+	}
+
+	// The meta is not read, only its length in bytes (length() of TEXT counts the characters)
+	const char* s_summarySelect = "SELECT id, parent_id, name, type, created, modified, data_size, "
+		"IFNULL((SELECT length(CAST(meta AS BLOB)) FROM ElementsMeta WHERE element_id = FileSystem.id), 0) FROM FileSystem ";
+
+	ElementSummary ReadSummary(SQLQuery& query)
+	{
+		ElementSummary summary;
+		summary.ID = query.ColumnInt64(0);
+		summary.ParentID = query.ColumnInt64(1);
+		query.ColumnText(2, summary.Name);
+		int type = query.ColumnInt(3);
+		if (type == ElementTypeUnknown || type > ElementTypeDirectLink)
+		{
+			throw ContainerException(ERR_DB, IS_DAMAGED);
+		}
+		summary.Type = static_cast<ElementType>(type);
+		summary.Created = query.ColumnInt64(4);
+		summary.Modified = query.ColumnInt64(5);
+		summary.Size = static_cast<uint64_t>(query.ColumnInt64(6));
+		summary.MetaLength = static_cast<uint64_t>(query.ColumnInt64(7));
+		return summary;
 	}
 }
 
-dbc::Container::Container(const std::string& path, const std::string& password, bool create)
-	: m_dbFile(path), m_connection(path, create), m_storage(new dbc::DataStorageBinaryFile)
+dbc::Container::Container(const std::string& path, const std::string& password, bool create, const ConnectionOptions& options)
+	: m_dbFile(path), m_connection(path, create), m_storage(new dbc::DataStorageBinaryFile), m_options(options)
 {
 	PrepareContainer(password, create);
 }
 
-dbc::Container::Container(const std::string& path, const std::string& password, IDataStorageGuard storage, bool create)
-	: m_dbFile(path), m_connection(path, create), m_storage(storage)
+dbc::Container::Container(const std::string& path, const std::string& password, IDataStorageGuard storage, bool create, const ConnectionOptions& options)
+	: m_dbFile(path), m_connection(path, create), m_storage(storage), m_options(options)
 {
 	PrepareContainer(password, create);
 }
@@ -147,6 +614,9 @@ void dbc::Container::Clear()
 	try
 	{
 		ClearDB(m_connection);
+		m_dentries.Clear();
+		m_resources->GetIdentityMap().Clear();
+		m_resources->GetFreeExtents().Invalidate();
 		m_storage->ClearData();
 	}
 	catch (const ContainerException &ex)
@@ -157,6 +627,8 @@ void dbc::Container::Clear()
 	try
 	{
 		BuildDB(m_connection);
+		SaveDataUsagePreferences(m_dataUsagePrefs); // They are kept by the cleared container
+		m_tuner.Reset();
 	}
 	catch (const ContainerException &ex)
 	{
@@ -176,7 +648,7 @@ std::string dbc::Container::GetPath() const
 
 dbc::FolderGuard dbc::Container::GetRoot()
 {
-	return FolderGuard(new Folder(m_resources, ROOT_ID));
+	return std::static_pointer_cast<Folder>(CreateElementObject(ROOT_ID, ElementTypeFolder));
 }
 
 dbc::ElementGuard dbc::Container::GetElement(const std::string& path)
@@ -189,27 +661,18 @@ dbc::ElementGuard dbc::Container::GetElement(const std::string& path)
 	std::vector<std::string> names;
 	dbc::utils::SplitSavingDelim(path, PATH_SEPARATOR, names);
 
-	int64_t parentId = 0;
-	int elementType = ElementTypeUnknown;
+	DentryCache::Dentry dentry;
 
-	SQLQuery query(m_connection, "SELECT id, type FROM FileSystem WHERE parent_id = ? AND name = ?;");
-	for (std::vector<std::string>::iterator itr = names.begin(); itr != names.end(); ++itr, query.Reset())
+	ReadConnection connection = m_readConnections->Checkout();
+	for (std::vector<std::string>::iterator itr = names.begin(); itr != names.end(); ++itr)
 	{
-		query.BindInt64(1, parentId);
 		*itr = dbc::utils::UnslashedPath(*itr);
-		query.BindText(2, *itr);
-		if (!query.Step())
+		if (!m_dentries.Lookup(*connection, dentry.id, *itr, dentry))
 		{
 			return ElementGuard(nullptr);
 		}
-		parentId = query.ColumnInt64(0);
-		elementType = query.ColumnInt(1);
-		if (query.Step()) // If there is one more file with the same name in the same directory
-		{
-			throw ContainerException(ERR_DB, IS_DAMAGED);
-		}
 	}
-	return CreateElementObject(parentId, static_cast<ElementType>(elementType));
+	return CreateElementObject(dentry.id, dentry.type);
 }
 
 ContainerInfo dbc::Container::GetInfo()
@@ -217,6 +680,59 @@ ContainerInfo dbc::Container::GetInfo()
 	return ContainerInfo(new ContainerInfoImpl(m_resources));
 }
 
+dbc::ElementGuards_vt dbc::Container::CreateElements(const std::string& folderPath, const ChildSpecs_vt& children)
+{
+	ElementGuard element = GetElement(folderPath);
+	if (!element || element->Type() != ElementTypeFolder)
+	{
+		throw ContainerException(ERR_DB_FS, CANT_CREATE, Element::s_notFoundError);
+	}
+	return element->AsFolder()->CreateChildren(children);
+}
+
+dbc::ElementSummaries_vt dbc::Container::GetInfoBatch(const std::vector<int64_t>& ids)
+{
+	std::unordered_map<int64_t, ElementSummary> found;
+	ReadConnection connection = m_readConnections->Checkout();
+	// The ids are read by chunks: the number of the query parameters is limited by SQLITE_MAX_VARIABLE_NUMBER (999)
+	const size_t chunkSize = 500;
+	for (std::vector<int64_t>::const_iterator chunkStart = ids.begin(); chunkStart != ids.end(); )
+	{
+		std::string queryStr(std::string(s_summarySelect) + "WHERE id IN (?");
+		std::vector<int64_t>::const_iterator chunkEnd = chunkStart;
+		size_t count = 1;
+		for (++chunkEnd; chunkEnd != ids.end() && count < chunkSize; ++chunkEnd, ++count)
+		{
+			queryStr.append(", ?");
+		}
+		queryStr.append(");");
+
+		SQLQuery query(*connection, queryStr);
+		int column = 1;
+		for (; chunkStart != chunkEnd; ++chunkStart)
+		{
+			query.BindInt64(column++, *chunkStart);
+		}
+		while (query.Step())
+		{
+			ElementSummary summary = ReadSummary(query);
+			found[summary.ID] = summary;
+		}
+	}
+
+	ElementSummaries_vt summaries;
+	summaries.reserve(found.size());
+	for (int64_t id : ids)
+	{
+		std::unordered_map<int64_t, ElementSummary>::const_iterator summary = found.find(id);
+		if (summary != found.end())
+		{
+			summaries.push_back(summary->second);
+		}
+	}
+	return summaries;
+}
+
 dbc::DataUsagePreferences dbc::Container::GetDataUsagePreferences() const
 {
 	return m_dataUsagePrefs;
@@ -224,12 +740,120 @@ dbc::DataUsagePreferences dbc::Container::GetDataUsagePreferences() const
 
 void dbc::Container::SetDataUsagePreferences(const DataUsagePreferences& prefs)
 {
+	SaveDataUsagePreferences(prefs);
+	if (prefs.AutoTune() != m_dataUsagePrefs.AutoTune())
+	{
+		m_tuner.Reset();
+	}
 	m_dataUsagePrefs = prefs;
+	m_storage->SetGrowth(prefs.StorageGrowth());
+}
+
+dbc::ConnectionOptions dbc::Container::GetConnectionOptions() const
+{
+	return m_options;
+}
+
+bool dbc::Container::IdleVacuum()
+{
+	if (!m_options.IncrementalVacuum())
+	{
+		return false;
+	}
+
+	SQLQuery query(m_connection, "PRAGMA auto_vacuum;");
+	query.Step();
+	if (query.ColumnInt(0) != 2) // The database was created without auto-vacuum, only VACUUM can release its pages
+	{
+		return false;
+	}
+
+	query.Prepare("PRAGMA freelist_count;");
+	query.Step();
+	if (query.ColumnInt64(0) == 0)
+	{
+		return false;
+	}
+
+	query.Prepare("PRAGMA incremental_vacuum(" + utils::NumberToString(m_options.VacuumStepPages()) + ");");
+	while (query.Step()); // Every step releases one page
+
+	query.Prepare("PRAGMA freelist_count;");
+	query.Step();
+	return query.ColumnInt64(0) > 0;
+}
+
+uint64_t dbc::Container::CoalesceFreeSpace()
+{
+	TransactionGuard transaction = m_connection.StartTransaction();
+	uint64_t merged = m_resources->GetFreeExtents().CoalesceAll(m_connection);
+	transaction->Commit();
+	return merged;
+}
+
+dbc::TuningDecisions_vt dbc::Container::GetTuningDecisions()
+{
+	TuningDecisions_vt decisions;
+	ReadConnection connection = m_readConnections->Checkout();
+	SQLQuery query(*connection, "SELECT time, samples, median_write_size, average_streams, waste_ratio, old_cluster_size_level, "
+		"new_cluster_size_level, old_tail_packing, new_tail_packing, reason FROM TuningDecisions ORDER BY id;");
+	while (query.Step())
+	{
+		TuningDecision decision;
+		decision.time = query.ColumnInt64(0);
+		decision.samples = query.ColumnInt64(1);
+		decision.medianWriteSize = query.ColumnInt64(2);
+		decision.averageStreams = query.ColumnDouble(3);
+		decision.wasteRatio = query.ColumnDouble(4);
+		decision.oldClusterSizeLevel = static_cast<unsigned short>(query.ColumnInt(5));
+		decision.newClusterSizeLevel = static_cast<unsigned short>(query.ColumnInt(6));
+		decision.oldTailPacking = query.ColumnBool(7);
+		decision.newTailPacking = query.ColumnBool(8);
+		query.ColumnText(9, decision.reason);
+		decisions.push_back(decision);
+	}
+	return decisions;
+}
+
+void dbc::Container::RecordWrite(uint64_t size, uint64_t streams)
+{
+	TuningDecision decision;
+	if (!m_dataUsagePrefs.AutoTune() || !m_tuner.RecordWrite(size, streams, m_dataUsagePrefs, decision))
+	{
+		return;
+	}
+
+	DataUsagePreferences tuned(m_dataUsagePrefs);
+	tuned.SetClusterSizeLevel(decision.newClusterSizeLevel);
+	tuned.SetTailPacking(decision.newTailPacking);
+	try
+	{
+		TransactionGuard transaction = m_connection.StartTransaction();
+		SaveTuningDecision(decision);
+		if (decision.Changed())
+		{
+			SaveDataUsagePreferences(tuned);
+		}
+		transaction->Commit();
+	}
+	catch (const ContainerException& ex)
+	{
+		// The write is already committed, the workload will be sampled again
+		WriteLog("Unable to save the tuning decision: " + ex.FullMessage());
+		return;
+	}
+	m_dataUsagePrefs = tuned;
+}
+
+dbc::Connection& dbc::Container::GetConnection()
+{
+	return m_connection;
 }
 
 dbc::ElementGuard dbc::Container::GetElement(int64_t id)
 {
-	SQLQuery query(m_connection, "SELECT type FROM FileSystem WHERE id = ?;");
+	ReadConnection connection = m_readConnections->Checkout();
+	SQLQuery query(*connection, "SELECT type FROM FileSystem WHERE id = ?;");
 	query.BindInt64(1, id);
 	if (!query.Step())
 	{
@@ -239,48 +863,109 @@ dbc::ElementGuard dbc::Container::GetElement(int64_t id)
 	return CreateElementObject(id, static_cast<ElementType>(type));
 }
 
+dbc::ElementSummaries_vt dbc::Container::GetChildrenSummaries(int64_t folderId)
+{
+	ElementSummaries_vt summaries;
+	ReadConnection connection = m_readConnections->Checkout();
+	SQLQuery query(*connection, std::string(s_summarySelect) + "WHERE parent_id = ? ORDER BY name;");
+	query.BindInt64(1, folderId);
+	while (query.Step())
+	{
+		summaries.push_back(ReadSummary(query));
+	}
+	return summaries;
+}
+
 dbc::ElementGuard dbc::Container::CreateElementObject(int64_t id, ElementType type)
 {
+	ElementGuard element = m_resources->GetIdentityMap().Find(id, type);
+	if (element)
+	{
+		return element;
+	}
+
 	switch (type)
 	{
 	case ElementTypeFolder:
-		return ElementGuard(new Folder(m_resources, id));
+		element.reset(new Folder(m_resources, id));
+		break;
 	case ElementTypeFile:
-		return ElementGuard(new File(m_resources, id));
+		element.reset(new File(m_resources, id));
+		break;
 	case ElementTypeSymLink:
-		return ElementGuard(new SymLink(m_resources, id));
+		element.reset(new SymLink(m_resources, id));
+		break;
 	case ElementTypeDirectLink:
-		return ElementGuard(new DirectLink(m_resources, id));
+		element.reset(new DirectLink(m_resources, id));
+		break;
 	default:
 		assert(!"Unknown element type specified");
 		throw ContainerException(ERR_INTERNAL);
 	}
+	return m_resources->GetIdentityMap().Insert(element);
 }
 
 dbc::ElementGuard dbc::Container::CreateElementObject(int64_t parentId, const std::string& name, ElementType type)
 {
+	ElementGuard element;
 	switch (type)
 	{
 	case ElementTypeFolder:
-		return ElementGuard(new Folder(m_resources, parentId, name));
+		element.reset(new Folder(m_resources, parentId, name));
+		break;
 	case ElementTypeFile:
-		return ElementGuard(new File(m_resources, parentId, name));
+		element.reset(new File(m_resources, parentId, name));
+		break;
 	case ElementTypeSymLink:
-		return ElementGuard(new SymLink(m_resources, parentId, name));
+		element.reset(new SymLink(m_resources, parentId, name));
+		break;
 	case ElementTypeDirectLink:
-		return ElementGuard(new DirectLink(m_resources, parentId, name));
+		element.reset(new DirectLink(m_resources, parentId, name));
+		break;
 	default:
 		assert(!"Unknown element type specified");
 		throw ContainerException(ERR_INTERNAL);
 	}
+	return m_resources->GetIdentityMap().Insert(element);
+}
+
+dbc::ElementGuard dbc::Container::CreateElementObject(const ElementInfo& info)
+{
+	ElementGuard element = m_resources->GetIdentityMap().Find(info.ID, info.Type);
+	if (element)
+	{
+		return element;
+	}
+
+	switch (info.Type)
+	{
+	case ElementTypeFolder:
+		element.reset(new Folder(m_resources, info));
+		break;
+	case ElementTypeFile:
+		element.reset(new File(m_resources, info));
+		break;
+	case ElementTypeSymLink:
+		element.reset(new SymLink(m_resources, info));
+		break;
+	case ElementTypeDirectLink:
+		element.reset(new DirectLink(m_resources, info));
+		break;
+	default:
+		assert(!"Unknown element type specified");
+		throw ContainerException(ERR_INTERNAL);
+	}
+	return m_resources->GetIdentityMap().Insert(element);
 }
 
 void dbc::Container::PrepareContainer(const std::string& password, bool create)
 {
 	assert(m_storage.get() != nullptr);
+	SetDBPragma(m_connection, m_options); // before the tables are created
 	if (create) // create DB and storage
 	{
 		BuildDB(m_connection);
+		SaveDataUsagePreferences(m_dataUsagePrefs);
 		m_storage->Create(m_dbFile, password);
 	}
 	else 
@@ -293,11 +978,20 @@ void dbc::Container::PrepareContainer(const std::string& password, bool create)
 		RawData storageData;
 		ReadSets(storageData);
 		m_storage->Open(m_dbFile, password, storageData);
+		UpgradeSchema(m_connection);
 		// TODO: Parse storage data
+		SQLQuery query(m_connection, "SELECT MAX(IFNULL((SELECT MAX(start + size) FROM FileStreams), 0), "
+			"IFNULL((SELECT MAX(start + size) FROM TailBlocks), 0));");
+		query.Step();
+		m_storage->SetDataEnd(query.ColumnInt64(0));
+		ReadDataUsagePreferences();
 	}
-	SetDBPragma(m_connection);
+	m_storage->SetGrowth(m_dataUsagePrefs.StorageGrowth());
 
-	m_resources.reset(new ContaierResourcesImpl(*this, m_connection, *m_storage));
+	m_readConnections = std::make_shared<ReadConnectionsPool>(m_connection, m_dbFile, m_options, ReadConnectionsCapacity(m_connection, m_options));
+	m_dentries.SetCapacity(m_options.DentryCacheSize());
+	m_resources.reset(new ContaierResourcesImpl(*this, m_connection, m_readConnections, *m_storage, m_dentries));
+	m_resources->GetFreeExtents().Load(m_connection);
 }
 
 void dbc::Container::ReadSets(RawData& storageData)
@@ -319,3 +1013,60 @@ void dbc::Container::SaveStorageData()
 		query.BindBlob(1, storageData);
 	}
 }
+
+void dbc::Container::ReadDataUsagePreferences()
+{
+	SQLQuery query(m_connection, "SELECT cluster_size_level, fragmentation_level, transactional_write, storage_growth, inline_data_threshold, "
+		"tail_packing, adaptive_cluster_size, auto_tune FROM Sets WHERE id = 1 AND cluster_size_level IS NOT NULL;");
+	if (!query.Step()) // Saved by the older version of the library, the defaults are used
+	{
+		return;
+	}
+
+	DataUsagePreferences prefs(
+		static_cast<unsigned short>(query.ColumnInt(0)),
+		static_cast<DataFragmentationLevel>(query.ColumnInt(1)),
+		query.ColumnBool(2),
+		static_cast<DataStorageGrowth>(query.ColumnInt(3)),
+		static_cast<unsigned int>(query.ColumnInt64(4)),
+		query.ColumnBool(5));
+	prefs.SetAdaptiveClusterSize(query.ColumnBool(6));
+	prefs.SetAutoTune(query.ColumnBool(7));
+	m_dataUsagePrefs = prefs;
+}
+
+void dbc::Container::SaveDataUsagePreferences(const DataUsagePreferences& prefs)
+{
+	SQLQuery query(m_connection, "UPDATE Sets SET cluster_size_level = ?, fragmentation_level = ?, transactional_write = ?, storage_growth = ?, "
+		"inline_data_threshold = ?, tail_packing = ?, adaptive_cluster_size = ?, auto_tune = ? WHERE id = 1;");
+	query.BindInt(1, prefs.ClusterSizeLevel());
+	query.BindInt(2, prefs.FragmentationLevel());
+	query.BindBool(3, prefs.TransactionalWrite());
+	query.BindInt(4, prefs.StorageGrowth());
+	query.BindInt64(5, prefs.InlineDataThreshold());
+	query.BindBool(6, prefs.TailPacking());
+	query.BindBool(7, prefs.AdaptiveClusterSize());
+	query.BindBool(8, prefs.AutoTune());
+	query.Step();
+}
+
+void dbc::Container::SaveTuningDecision(const TuningDecision& decision)
+{
+	SQLQuery query(m_connection, "INSERT INTO TuningDecisions(time, samples, median_write_size, average_streams, waste_ratio, old_cluster_size_level, "
+		"new_cluster_size_level, old_tail_packing, new_tail_packing, reason) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?);");
+	query.BindInt64(1, decision.time);
+	query.BindInt64(2, decision.samples);
+	query.BindInt64(3, decision.medianWriteSize);
+	query.BindDouble(4, decision.averageStreams);
+	query.BindDouble(5, decision.wasteRatio);
+	query.BindInt(6, decision.oldClusterSizeLevel);
+	query.BindInt(7, decision.newClusterSizeLevel);
+	query.BindBool(8, decision.oldTailPacking);
+	query.BindBool(9, decision.newTailPacking);
+	query.BindText(10, decision.reason);
+	query.Step();
+	int64_t lastId = query.LastRowId();
+	query.Prepare("DELETE FROM TuningDecisions WHERE id <= ?;");
+	query.BindInt64(1, lastId - static_cast<int64_t>(s_maxTuningDecisions));
+	query.Step();
+}
@@ -1,7 +1,10 @@
 #pragma once
 #include "Connection.h"
+#include "ReadConnectionsPool.h"
+#include "DentryCache.h"
 #include "IContainer.h"
 #include "IDataStorage.h"
+#include "WorkloadTuner.h"
 
 struct sqlite3;
 
@@ -17,8 +20,8 @@ namespace dbc
 	public:
 		static const int ROOT_ID; // Default id for the root folder in FileSystem table
 		
-		Container(const std::string& path, const std::string& password, bool create = false);
-		Container(const std::string& path, const std::string& password, IDataStorageGuard storage, bool create = false);
+		Container(const std::string& path, const std::string& password, bool create = false, const ConnectionOptions& options = ConnectionOptions());
+		Container(const std::string& path, const std::string& password, IDataStorageGuard storage, bool create = false, const ConnectionOptions& options = ConnectionOptions());
 		~Container();
 
 		// from IContainer
@@ -29,25 +32,45 @@ namespace dbc
 		virtual FolderGuard GetRoot();
 		virtual ElementGuard GetElement(const std::string& path);
 		virtual ContainerInfo GetInfo();
+		virtual ElementGuards_vt CreateElements(const std::string& folderPath, const ChildSpecs_vt& children);
+		virtual ElementSummaries_vt GetInfoBatch(const std::vector<int64_t>& ids);
 
 		virtual DataUsagePreferences GetDataUsagePreferences() const;
 		virtual void SetDataUsagePreferences(const DataUsagePreferences& prefs);
+
+		virtual ConnectionOptions GetConnectionOptions() const;
+		virtual bool IdleVacuum();
+		virtual uint64_t CoalesceFreeSpace();
+		virtual TuningDecisions_vt GetTuningDecisions();
 		// ~from IContainer
 
 		ElementGuard GetElement(int64_t id);
+		ElementSummaries_vt GetChildrenSummaries(int64_t folderId); // In the order of the names
+		// The live object of the element is returned if it is held somewhere (see ElementsIdentityMap)
 		ElementGuard CreateElementObject(int64_t id, ElementType type);
 		ElementGuard CreateElementObject(int64_t parentId, const std::string& name, ElementType type);
+		ElementGuard CreateElementObject(const ElementInfo& info); // From the already fetched row
+		Connection& GetConnection(); // The primary connection, for the diagnostics
+		// Samples the write for DataUsagePreferences::AutoTune(). Called after the write is committed.
+		void RecordWrite(uint64_t size, uint64_t streams);
 
 	private:
 		void PrepareContainer(const std::string &password, bool create);
 		void ReadSets(RawData& storageData);
 		void SaveStorageData();
+		void ReadDataUsagePreferences();
+		void SaveDataUsagePreferences(const DataUsagePreferences& prefs);
+		void SaveTuningDecision(const TuningDecision& decision);
 
 	private:
 		Connection m_connection; // Connection guard. It contains the database pointer and the path to the database file.
 		std::string m_dbFile;
+		ReadConnectionsPoolGuard m_readConnections; // Must be destroyed before m_connection
 		IDataStorageGuard m_storage;
 		DataUsagePreferences m_dataUsagePrefs;
+		ConnectionOptions m_options;
+		DentryCache m_dentries;
+		WorkloadTuner m_tuner;
 
 		ContainerResources m_resources;
 	};
@@ -3,11 +3,11 @@
 #include "Container.h"
 #include "ContainerException.h"
 
-dbc::ContainerGuard dbc::CreateContainer(const std::string& path, const std::string& password)
+dbc::ContainerGuard dbc::CreateContainer(const std::string& path, const std::string& password, const ConnectionOptions& options)
 {
 	try
 	{
-		return ContainerGuard(new Container(path, password, true));
+		return ContainerGuard(new Container(path, password, true, options));
 	}
 	catch (const ContainerException& ex)
 	{
@@ -15,11 +15,11 @@ dbc::ContainerGuard dbc::CreateContainer(const std::string& path, const std::str
 	}
 }
 
-dbc::ContainerGuard dbc::CreateContainer(const std::string& path, const std::string& password, IDataStorageGuard storage)
+dbc::ContainerGuard dbc::CreateContainer(const std::string& path, const std::string& password, IDataStorageGuard storage, const ConnectionOptions& options)
 {
 	try
 	{
-		return ContainerGuard(new Container(path, password, storage, true));
+		return ContainerGuard(new Container(path, password, storage, true, options));
 	}
 	catch (const ContainerException& ex)
 	{
@@ -27,12 +27,12 @@ dbc::ContainerGuard dbc::CreateContainer(const std::string& path, const std::str
 	}
 }
 
-dbc::ContainerGuard dbc::Connect(const std::string& dbPath, const std::string& password)
+dbc::ContainerGuard dbc::Connect(const std::string& dbPath, const std::string& password, const ConnectionOptions& options)
 {
-	return ContainerGuard(new Container(dbPath, password, false));
+	return ContainerGuard(new Container(dbPath, password, false, options));
 }
 
-dbc::ContainerGuard dbc::Connect(const std::string& dbPath, const std::string& password, IDataStorageGuard storage)
+dbc::ContainerGuard dbc::Connect(const std::string& dbPath, const std::string& password, IDataStorageGuard storage, const ConnectionOptions& options)
 {
-	return ContainerGuard(new Container(dbPath, password, storage, false));
+	return ContainerGuard(new Container(dbPath, password, storage, false, options));
 }
\ No newline at end of file
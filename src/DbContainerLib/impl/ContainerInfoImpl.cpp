@@ -14,14 +14,16 @@ bool dbc::ContainerInfoImpl::IsEmpty()
 
 uint64_t dbc::ContainerInfoImpl::TotalElements()
 {
-	SQLQuery query(m_resources->GetConnection(), "SELECT count(*) FROM FileSystem;");
+	ReadConnection connection = m_resources->GetReadConnection();
+	SQLQuery query(*connection, "SELECT count(*) FROM FileSystem;");
 	query.Step();
 	return query.ColumnInt64(0);
 }
 
 uint64_t dbc::ContainerInfoImpl::TotalElements(ElementType type)
 {
-	SQLQuery query(m_resources->GetConnection(), "SELECT count(*) FROM FileSystem WHERE type = ?;");
+	ReadConnection connection = m_resources->GetReadConnection();
+	SQLQuery query(*connection, "SELECT count(*) FROM FileSystem WHERE type = ?;");
 	query.BindInt(1, type);
 	query.Step();
 	return query.ColumnInt64(0);
@@ -29,28 +31,61 @@ uint64_t dbc::ContainerInfoImpl::TotalElements(ElementType type)
 
 uint64_t dbc::ContainerInfoImpl::UsedSpace()
 {
-	SQLQuery query(m_resources->GetConnection(), "SELECT SUM(used) FROM FileStreams;");
+	ReadConnection connection = m_resources->GetReadConnection();
+	SQLQuery query(*connection, "SELECT SUM(used) FROM FileStreams;");
 	query.Step();
 	return query.ColumnInt64(0);
 }
 
 uint64_t dbc::ContainerInfoImpl::FreeSpace()
 {
-	SQLQuery query(m_resources->GetConnection(), "SELECT SUM(size - used) FROM FileStreams;");
+	ReadConnection connection = m_resources->GetReadConnection();
+	SQLQuery query(*connection, "SELECT SUM(size - used) FROM FileStreams;");
+	query.Step();
+	return query.ColumnInt64(0);
+}
+
+uint64_t dbc::ContainerInfoImpl::ReservedSpace()
+{
+	return m_resources->Storage().ReservedSpace();
+}
+
+uint64_t dbc::ContainerInfoImpl::InlineSpace()
+{
+	ReadConnection connection = m_resources->GetReadConnection();
+	SQLQuery query(*connection, "SELECT IFNULL(SUM(size), 0) FROM InlineData;");
+	query.Step();
+	return query.ColumnInt64(0);
+}
+
+uint64_t dbc::ContainerInfoImpl::TailBlocksSpace()
+{
+	ReadConnection connection = m_resources->GetReadConnection();
+	SQLQuery query(*connection, "SELECT IFNULL(SUM(size), 0) FROM TailBlocks;");
+	query.Step();
+	return query.ColumnInt64(0);
+}
+
+uint64_t dbc::ContainerInfoImpl::TailsSpace()
+{
+	ReadConnection connection = m_resources->GetReadConnection();
+	SQLQuery query(*connection, "SELECT IFNULL(SUM(size), 0) FROM FileTails;");
 	query.Step();
 	return query.ColumnInt64(0);
 }
 
 uint64_t dbc::ContainerInfoImpl::TotalStreams()
 {
-	SQLQuery query(m_resources->GetConnection(), "SELECT COUNT(*) FROM FileStreams;");
+	ReadConnection connection = m_resources->GetReadConnection();
+	SQLQuery query(*connection, "SELECT COUNT(*) FROM FileStreams;");
 	query.Step();
 	return query.ColumnInt64(0);
 }
 
 uint64_t dbc::ContainerInfoImpl::UsedStreams()
 {
-	SQLQuery query(m_resources->GetConnection(), "SELECT COUNT(*) FROM FileStreams WHERE used != 0;");
+	ReadConnection connection = m_resources->GetReadConnection();
+	SQLQuery query(*connection, "SELECT COUNT(*) FROM FileStreams WHERE used != 0;");
 	query.Step();
 	return query.ColumnInt64(0);
 }
\ No newline at end of file
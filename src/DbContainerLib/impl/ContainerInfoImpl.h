@@ -17,6 +17,10 @@ namespace dbc
 		virtual uint64_t TotalElements(ElementType type);
 		virtual uint64_t UsedSpace();
 		virtual uint64_t FreeSpace();
+		virtual uint64_t ReservedSpace();
+		virtual uint64_t InlineSpace();
+		virtual uint64_t TailBlocksSpace();
+		virtual uint64_t TailsSpace();
 		virtual uint64_t TotalStreams();
 		virtual uint64_t UsedStreams();
 
@@ -5,10 +5,14 @@
 dbc::ContaierResourcesImpl::ContaierResourcesImpl(
 	Container& container,
 	Connection& connection,
-	IDataStorage& dataStorage)
+	ReadConnectionsPoolGuard readConnections,
+	IDataStorage& dataStorage,
+	DentryCache& dentries)
 	: m_container(container)
 	, m_connection(connection)
+	, m_readConnections(readConnections)
 	, m_dataStorage(dataStorage)
+	, m_dentries(dentries)
 	, m_contaierAlive(true)
 { }
 
@@ -23,6 +27,12 @@ dbc::Connection& dbc::ContaierResourcesImpl::GetConnection()
 	return m_connection;
 }
 
+dbc::ReadConnection dbc::ContaierResourcesImpl::GetReadConnection()
+{
+	CheckUsefulnessAndThrow(ERR_DB_NO_CONNECTION);
+	return m_readConnections->Checkout();
+}
+
 dbc::Container& dbc::ContaierResourcesImpl::GetContainer()
 {
 	CheckUsefulnessAndThrow(ERR_DB_NO_CONNECTION);
@@ -35,12 +45,30 @@ dbc::IDataStorage& dbc::ContaierResourcesImpl::Storage()
 	return m_dataStorage;
 }
 
+dbc::DentryCache& dbc::ContaierResourcesImpl::GetDentries()
+{
+	CheckUsefulnessAndThrow(CONTAINER_RESOURCES_NOT_AVAILABLE);
+	return m_dentries;
+}
+
 dbc::ElementsSyncKeeper& dbc::ContaierResourcesImpl::GetSync()
 {
 	CheckUsefulnessAndThrow(CONTAINER_RESOURCES_NOT_AVAILABLE);
 	return m_synkKeeper;
 }
 
+dbc::ElementsIdentityMap& dbc::ContaierResourcesImpl::GetIdentityMap()
+{
+	CheckUsefulnessAndThrow(CONTAINER_RESOURCES_NOT_AVAILABLE);
+	return m_identityMap;
+}
+
+dbc::FreeExtentsIndex& dbc::ContaierResourcesImpl::GetFreeExtents()
+{
+	CheckUsefulnessAndThrow(CONTAINER_RESOURCES_NOT_AVAILABLE);
+	return m_freeExtents;
+}
+
 void dbc::ContaierResourcesImpl::ReportContainerDied()
 {
 	m_contaierAlive = false;
@@ -1,6 +1,8 @@
 #pragma once
 #include "IContainnerResources.h"
 #include "ElementsSyncKeeper.h"
+#include "ElementsIdentityMap.h"
+#include "FreeExtentsIndex.h"
 
 namespace dbc
 {
@@ -9,13 +11,17 @@ namespace dbc
 	class ContaierResourcesImpl: public IContainerResources
 	{
 	public:
-		ContaierResourcesImpl(Container& container, Connection& connection, IDataStorage& dataStorage);
+		ContaierResourcesImpl(Container& container, Connection& connection, ReadConnectionsPoolGuard readConnections, IDataStorage& dataStorage, DentryCache& dentries);
 
 		virtual bool ContainerAlive();
 		virtual Container& GetContainer();
 		virtual Connection& GetConnection();
+		virtual ReadConnection GetReadConnection();
 		virtual IDataStorage& Storage();
+		virtual DentryCache& GetDentries();
 		virtual ElementsSyncKeeper& GetSync();
+		virtual ElementsIdentityMap& GetIdentityMap();
+		virtual FreeExtentsIndex& GetFreeExtents();
 
 		void ReportContainerDied() throw();
 
@@ -25,8 +31,12 @@ namespace dbc
 	private:
 		Container& m_container;
 		Connection& m_connection;
+		ReadConnectionsPoolGuard m_readConnections;
 		IDataStorage& m_dataStorage;
+		DentryCache& m_dentries;
 		ElementsSyncKeeper m_synkKeeper;
+		ElementsIdentityMap m_identityMap;
+		FreeExtentsIndex m_freeExtents;
 		bool m_contaierAlive;
 	};
 }
\ No newline at end of file
@@ -12,6 +12,13 @@ namespace
 	const size_t s_binHeaderLen = s_maxPasswordLen * 4;
 	const std::string s_binFileExt = ".bin";
 	const std::string s_testExpression = "Database Container Project";
+	const uint64_t s_growthChunk = 1024 * 1024;
+	const uint64_t s_maxGeometricGrowth = 64 * s_growthChunk;
+
+	uint64_t RoundUpToChunk(uint64_t size)
+	{
+		return (size + s_growthChunk - 1) / s_growthChunk * s_growthChunk;
+	}
 
 	std::string GetBinFilePath(const std::string& dbPath)
 	{
@@ -69,6 +76,9 @@ namespace
 
 dbc::DataStorageBinaryFile::DataStorageBinaryFile()
 	: m_cryptBlockSize(crypto::AesCryptorBase::GetDefIoBlockSize())
+	, m_growth(DataStorageGrowthGeometric)
+	, m_dataEnd(0)
+	, m_fileEnd(0)
 { }
 
 void dbc::DataStorageBinaryFile::Open(const std::string& db_path, const std::string& password, const RawData& savedData)
@@ -85,6 +95,9 @@ void dbc::DataStorageBinaryFile::Open(const std::string& db_path, const std::str
 	{
 		throw ContainerException(INVALID_PASSWORD);
 	}
+	m_stream.seekg(0, std::ios::end);
+	m_fileEnd = m_stream.tellg();
+	m_dataEnd = m_fileEnd; // Until the container reports the end of its streams
 
 	m_key.swap(key);
 	m_iv.swap(iv);
@@ -100,6 +113,8 @@ void dbc::DataStorageBinaryFile::Create(const std::string& db_path, const std::s
 	dbc::RawData iv;
 	GetKeyAndIvFromPassword(password, key, iv);
 	FillHeader(password, key, iv, m_stream);
+	m_dataEnd = s_binHeaderLen;
+	m_fileEnd = s_binHeaderLen;
 
 	m_key.swap(key);
 	m_iv.swap(iv);
@@ -137,6 +152,8 @@ void dbc::DataStorageBinaryFile::ClearData()
 	{
 		throw ContainerException(ERR_DATA, CANT_WRITE);
 	}
+	m_dataEnd = s_binHeaderLen;
+	m_fileEnd = s_binHeaderLen;
 }
 
 void dbc::DataStorageBinaryFile::GetDataToSave(RawData& data)
@@ -144,6 +161,28 @@ void dbc::DataStorageBinaryFile::GetDataToSave(RawData& data)
     data.clear();
 }
 
+void dbc::DataStorageBinaryFile::SetDataEnd(uint64_t end)
+{
+	CheckInitialized();
+
+	// The space after the end of the streams was preallocated or appended by the rolled back writes
+	m_dataEnd = end > s_binHeaderLen ? end : s_binHeaderLen;
+	if (m_fileEnd < m_dataEnd)
+	{
+		throw ContainerException(ERR_DATA, IS_DAMAGED);
+	}
+}
+
+void dbc::DataStorageBinaryFile::SetGrowth(DataStorageGrowth growth)
+{
+	m_growth = growth;
+}
+
+uint64_t dbc::DataStorageBinaryFile::ReservedSpace()
+{
+	return m_fileEnd - m_dataEnd;
+}
+
 uint64_t dbc::DataStorageBinaryFile::Write(std::istream& data, uint64_t begin, uint64_t end, dbc::IProgressObserver* observer)
 {
 	CheckInitialized();
@@ -241,13 +280,43 @@ uint64_t dbc::DataStorageBinaryFile::Erace(uint64_t begin, uint64_t end, dbc::IP
 
 uint64_t dbc::DataStorageBinaryFile::Append(uint64_t size, uint64_t& begin, dbc::IProgressObserver* observer)
 {
-	m_stream.seekg(0, std::ios::end);
-	if (!m_stream.good())
+	CheckInitialized();
+
+	begin = m_dataEnd;
+	if (m_dataEnd + size > m_fileEnd)
 	{
-		return WRONG_SIZE;
+		uint64_t fileEnd = GrownFileEnd(m_dataEnd + size);
+		m_stream.flush();
+		// The new space is encrypted before it is read, so it doesn't need to be zeroed
+		if (!utils::ExtendFile(m_bin_file, fileEnd))
+		{
+			uint64_t erased = Erace(m_fileEnd, fileEnd, observer);
+			if (erased != fileEnd - m_fileEnd)
+			{
+				m_fileEnd += erased;
+				return m_fileEnd > begin ? m_fileEnd - begin : 0;
+			}
+		}
+		m_fileEnd = fileEnd;
 	}
-	begin = m_stream.tellg();
-	return Erace(begin, begin + size, observer);
+	m_dataEnd += size;
+	return size;
+}
+
+void dbc::DataStorageBinaryFile::Encrypt(const RawData& data, RawData& result)
+{
+	CheckInitialized();
+
+	crypto::AesEncryptor encryptor(m_key, m_iv);
+	encryptor.Encrypt(data, result);
+}
+
+void dbc::DataStorageBinaryFile::Decrypt(const RawData& data, RawData& result)
+{
+	CheckInitialized();
+
+	crypto::AesDecryptor decryptor(m_key, m_iv);
+	decryptor.Decrypt(data, result);
 }
 
 void dbc::DataStorageBinaryFile::OpenFileStream(bool truncate)
@@ -283,6 +352,24 @@ void dbc::DataStorageBinaryFile::CheckInitialized()
 	}
 }
 
+uint64_t dbc::DataStorageBinaryFile::GrownFileEnd(uint64_t requiredEnd) const
+{
+	switch (m_growth)
+	{
+	case DataStorageGrowthChunked:
+		return RoundUpToChunk(requiredEnd);
+	case DataStorageGrowthGeometric:
+	{
+		uint64_t growth = m_fileEnd / 8;
+		growth = growth < s_growthChunk ? s_growthChunk : (growth > s_maxGeometricGrowth ? s_maxGeometricGrowth : growth);
+		uint64_t grownEnd = RoundUpToChunk(m_fileEnd + growth);
+		return grownEnd > requiredEnd ? grownEnd : RoundUpToChunk(requiredEnd);
+	}
+	default:
+		return requiredEnd;
+	}
+}
+
 void dbc::DataStorageBinaryFile::ClearFile()
 {
 	std::ofstream bfile(m_bin_file, std::ios::out | std::ios::trunc);
@@ -15,6 +15,9 @@ namespace dbc
 		virtual void ResetPassword(const std::string& newPassword);
 		virtual void ClearData();
 		virtual void GetDataToSave(RawData& data);
+		virtual void SetDataEnd(uint64_t end);
+		virtual void SetGrowth(DataStorageGrowth growth);
+		virtual uint64_t ReservedSpace();
 
 		virtual uint64_t Write(std::istream& data, uint64_t begin, uint64_t end, dbc::IProgressObserver* observer = nullptr);
 		virtual uint64_t Read(std::ostream& data, uint64_t begin, uint64_t end, dbc::IProgressObserver* observer = nullptr);
@@ -23,10 +26,14 @@ namespace dbc
 
 		virtual uint64_t Append(uint64_t size, uint64_t& begin, dbc::IProgressObserver* observer);
 
+		virtual void Encrypt(const RawData& data, RawData& result);
+		virtual void Decrypt(const RawData& data, RawData& result);
+
 	private:
 		void OpenFileStream(bool truncate);
 		void CheckInitialized();
 		void ClearFile();
+		uint64_t GrownFileEnd(uint64_t requiredEnd) const;
 
 	private:
 		RawData m_key; // AES key
@@ -34,5 +41,8 @@ namespace dbc
 		std::string m_bin_file;
 		std::fstream m_stream;
 		unsigned long m_cryptBlockSize;
+		DataStorageGrowth m_growth;
+		uint64_t m_dataEnd; // The streams are appended here
+		uint64_t m_fileEnd; // The space between m_dataEnd and m_fileEnd is preallocated
 	};
 }
\ No newline at end of file
@@ -11,16 +11,33 @@ namespace
 		}
 		return level;
 	}
+
+	unsigned int NormalizeInlineDataThreshold(unsigned int size)
+	{
+		if (size > dbc::DataUsagePreferences::INLINE_DATA_THRESHOLD_MAX)
+		{
+			return dbc::DataUsagePreferences::INLINE_DATA_THRESHOLD_MAX;
+		}
+		return size;
+	}
 }
 
 dbc::DataUsagePreferences::DataUsagePreferences(
 	unsigned short clusterSizeLevel,
 	DataFragmentationLevel fragmentationLevel,
-	bool transactionalWrite)
+	bool transactionalWrite,
+	DataStorageGrowth storageGrowth,
+	unsigned int inlineDataThreshold,
+	bool tailPacking)
 	: m_clusterSizeLevel(NormalizeClusterSizeLevel(clusterSizeLevel))
 	, m_clusterSize(GetRealClusterSize(m_clusterSizeLevel))
 	, m_fragmentationLevel(fragmentationLevel)
 	, m_transactionalWrite(transactionalWrite)
+	, m_storageGrowth(storageGrowth)
+	, m_inlineDataThreshold(NormalizeInlineDataThreshold(inlineDataThreshold))
+	, m_tailPacking(tailPacking)
+	, m_adaptiveClusterSize(false)
+	, m_autoTune(false)
 { }
 
 unsigned short dbc::DataUsagePreferences::ClusterSizeLevel() const
@@ -33,6 +50,21 @@ unsigned int dbc::DataUsagePreferences::ClusterSize() const
 	return m_clusterSize;
 }
 
+unsigned int dbc::DataUsagePreferences::ClusterSizeFor(uint64_t writeSize) const
+{
+	if (!m_adaptiveClusterSize)
+	{
+		return m_clusterSize;
+	}
+	// The largest cluster which is not more than 1/16 of the write, so the last partial cluster wastes less than 1/16 of it
+	unsigned short level = CLUSTER_SIZE_MIN;
+	while (level < m_clusterSizeLevel && GetRealClusterSize(level + 1) * static_cast<uint64_t>(16) <= writeSize)
+	{
+		++level;
+	}
+	return GetRealClusterSize(level);
+}
+
 dbc::DataFragmentationLevel dbc::DataUsagePreferences::FragmentationLevel() const
 {
 	return m_fragmentationLevel;
@@ -43,6 +75,31 @@ bool dbc::DataUsagePreferences::TransactionalWrite() const
 	return m_transactionalWrite;
 }
 
+dbc::DataStorageGrowth dbc::DataUsagePreferences::StorageGrowth() const
+{
+	return m_storageGrowth;
+}
+
+unsigned int dbc::DataUsagePreferences::InlineDataThreshold() const
+{
+	return m_inlineDataThreshold;
+}
+
+bool dbc::DataUsagePreferences::TailPacking() const
+{
+	return m_tailPacking;
+}
+
+bool dbc::DataUsagePreferences::AdaptiveClusterSize() const
+{
+	return m_adaptiveClusterSize;
+}
+
+bool dbc::DataUsagePreferences::AutoTune() const
+{
+	return m_autoTune;
+}
+
 void dbc::DataUsagePreferences::SetClusterSizeLevel(unsigned short level)
 {
 	m_clusterSizeLevel = NormalizeClusterSizeLevel(level);
@@ -59,6 +116,31 @@ void dbc::DataUsagePreferences::SetTransactionalWrite(bool enabled)
 	m_transactionalWrite = enabled;
 }
 
+void dbc::DataUsagePreferences::SetStorageGrowth(DataStorageGrowth growth)
+{
+	m_storageGrowth = growth;
+}
+
+void dbc::DataUsagePreferences::SetInlineDataThreshold(unsigned int size)
+{
+	m_inlineDataThreshold = NormalizeInlineDataThreshold(size);
+}
+
+void dbc::DataUsagePreferences::SetTailPacking(bool enabled)
+{
+	m_tailPacking = enabled;
+}
+
+void dbc::DataUsagePreferences::SetAdaptiveClusterSize(bool enabled)
+{
+	m_adaptiveClusterSize = enabled;
+}
+
+void dbc::DataUsagePreferences::SetAutoTune(bool enabled)
+{
+	m_autoTune = enabled;
+}
+
 unsigned int dbc::DataUsagePreferences::GetRealClusterSize(unsigned short level)
 {
 	level = NormalizeClusterSizeLevel(level);
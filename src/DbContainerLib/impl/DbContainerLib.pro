@@ -14,6 +14,7 @@ INCLUDEPATH += . \
 
 SOURCES += \
     Connection.cpp \
+    ConnectionOptions.cpp \
     Container.cpp \
     ContainerAPI.cpp \
     ContainerDefragmenter.cpp \
@@ -24,20 +25,28 @@ SOURCES += \
     DataStorageBinaryFile.cpp \
     DataUsagePreferences.cpp \
     DefragProxyProgressObserver.cpp \
+    DentryCache.cpp \
     DirectLink.cpp \
     Element.cpp \
     ElementProperties.cpp \
+    ElementsIdentityMap.cpp \
     ElementsIterator.cpp \
     ElementsSyncKeeper.cpp \
     ErrorCodes.cpp \
     File.cpp \
     FileStreamsAllocator.cpp \
     FileStreamsManager.cpp \
+    FileWriter.cpp \
     Folder.cpp \
+    FreeExtentsIndex.cpp \
+    ListFilter.cpp \
     ProxyProgressObserver.cpp \
+    ReadConnectionsPool.cpp \
     SQLQuery.cpp \
+    StatementsCache.cpp \
     SymLink.cpp \
     TransactionGuard.cpp \
+    WorkloadTuner.cpp \
     Utils/CommonUtils.cpp \
     Utils/FileStreamsUtils.cpp \
     Utils/FsUtils.cpp \
@@ -45,6 +54,7 @@ SOURCES += \
     Link.cpp
 
 HEADERS += \
+    ../ConnectionOptions.h \
     ../ContainerAPI.h \
     ../ContainerException.h \
     ../ContainerResources.h \
@@ -55,6 +65,7 @@ HEADERS += \
     ../ElementsIterator.h \
     ../ErrorCodes.h \
     ../File.h \
+    ../FileWriter.h \
     ../Folder.h \
     ../IContainer.h \
     ../IContainerInfo.h \
@@ -62,7 +73,9 @@ HEADERS += \
     ../IDefragProgressObserver.h \
     ../IProgressObserver.h \
     ../Iterator.h \
+    ../ListFilter.h \
     ../SymLink.h \
+    ../TuningDecision.h \
     ../Types.h \
     Connection.h \
     Container.h \
@@ -72,15 +85,21 @@ HEADERS += \
     Crypto.h \
     DataStorageBinaryFile.h \
     DefragProxyProgressObserver.h \
+    DentryCache.h \
+    ElementsIdentityMap.h \
     ElementsSyncKeeper.h \
     FileStreamsAllocator.h \
     FileStreamsManager.h \
+    FreeExtentsIndex.h \
     IContainnerResources.h \
     ProxyProgressObserver.h \
+    ReadConnectionsPool.h \
     SQLQuery.h \
+    StatementsCache.h \
     StreamInfo.h \
     TransactionGuard.h \
     TypesInternal.h \
+    WorkloadTuner.h \
     Utils/CommonUtils.h \
     Utils/FileStreamsUtils.h \
     Utils/FsUtils.h \
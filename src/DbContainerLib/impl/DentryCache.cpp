@@ -0,0 +1,170 @@
+#include "stdafx.h"
+#include "DentryCache.h"
+#include "Connection.h"
+#include "SQLQuery.h"
+#include "ContainerException.h"
+#include "CommonUtils.h"
+
+namespace
+{
+	// Names can't contain the path separator, so the key is unique
+	std::string MakeKey(int64_t parentId, const std::string& name)
+	{
+		return dbc::utils::NumberToString(parentId) + dbc::PATH_SEPARATOR + name;
+	}
+}
+
+dbc::DentryCache::DentryCache(size_t capacity)
+	: m_capacity(capacity)
+	, m_generation(0)
+{ }
+
+bool dbc::DentryCache::Lookup(Connection& connection, int64_t parentId, const std::string& name, Dentry& dentry)
+{
+	std::string key = MakeKey(parentId, name);
+	uint64_t generation = 0;
+	{
+		MutexLock lock(m_mutex);
+		DentriesIndex_mp::iterator found = m_index.find(key);
+		if (found != m_index.end())
+		{
+			m_dentries.splice(m_dentries.begin(), m_dentries, found->second);
+			dentry = found->second->dentry;
+			++m_stats.hits;
+			return dentry.id != 0;
+		}
+		++m_stats.misses;
+		generation = m_generation;
+	}
+
+	SQLQuery query(connection, "SELECT id, type FROM FileSystem WHERE parent_id = ? AND name = ?;");
+	query.BindInt64(1, parentId);
+	query.BindText(2, name);
+	dentry = Dentry();
+	if (query.Step())
+	{
+		dentry = Dentry(query.ColumnInt64(0), static_cast<ElementType>(query.ColumnInt(1)));
+		if (query.Step()) // If there is one more element with the same name in the same folder
+		{
+			throw ContainerException(ERR_DB, IS_DAMAGED);
+		}
+	}
+
+	// Uncommitted changes of the opened transaction may be rolled back
+	if (!connection.InTransaction())
+	{
+		MutexLock lock(m_mutex);
+		if (generation == m_generation)
+		{
+			Insert(key, parentId, dentry);
+		}
+	}
+	return dentry.id != 0;
+}
+
+void dbc::DentryCache::Invalidate(int64_t parentId, const std::string& name)
+{
+	MutexLock lock(m_mutex);
+	++m_generation;
+	DentriesIndex_mp::iterator found = m_index.find(MakeKey(parentId, name));
+	if (found != m_index.end())
+	{
+		Erase(found->second);
+	}
+}
+
+void dbc::DentryCache::InvalidateElement(int64_t id)
+{
+	MutexLock lock(m_mutex);
+	++m_generation;
+	DentriesById_mp::iterator found = m_byId.find(id);
+	if (found != m_byId.end())
+	{
+		Erase(found->second);
+	}
+}
+
+void dbc::DentryCache::InvalidateElements(const ElementsIds_st& ids)
+{
+	MutexLock lock(m_mutex);
+	++m_generation;
+	for (Dentries_lst::iterator dentry = m_dentries.begin(); dentry != m_dentries.end(); )
+	{
+		Dentries_lst::iterator current = dentry++;
+		if (ids.count(current->parentId) != 0 || ids.count(current->dentry.id) != 0)
+		{
+			Erase(current);
+		}
+	}
+}
+
+void dbc::DentryCache::Clear()
+{
+	MutexLock lock(m_mutex);
+	++m_generation;
+	m_dentries.clear();
+	m_index.clear();
+	m_byId.clear();
+}
+
+void dbc::DentryCache::SetCapacity(size_t capacity)
+{
+	MutexLock lock(m_mutex);
+	m_capacity = capacity;
+	TrimToCapacity();
+}
+
+dbc::DentryCache::Statistics dbc::DentryCache::GetStatistics()
+{
+	MutexLock lock(m_mutex);
+	Statistics stats(m_stats);
+	stats.size = m_dentries.size();
+	return stats;
+}
+
+void dbc::DentryCache::Insert(const std::string& key, int64_t parentId, const Dentry& dentry)
+{
+	if (m_capacity == 0 || m_index.find(key) != m_index.end())
+	{
+		return;
+	}
+	if (dentry.id != 0)
+	{
+		DentriesById_mp::iterator sameElement = m_byId.find(dentry.id);
+		if (sameElement != m_byId.end()) // The element was found by another key, it is outdated
+		{
+			Erase(sameElement->second);
+		}
+	}
+
+	CachedDentry cached;
+	cached.key = key;
+	cached.parentId = parentId;
+	cached.dentry = dentry;
+	m_dentries.push_front(cached);
+	m_index[key] = m_dentries.begin();
+	if (dentry.id != 0)
+	{
+		m_byId[dentry.id] = m_dentries.begin();
+	}
+	TrimToCapacity();
+}
+
+void dbc::DentryCache::Erase(Dentries_lst::iterator dentry)
+{
+	m_index.erase(dentry->key);
+	DentriesById_mp::iterator byId = m_byId.find(dentry->dentry.id);
+	if (byId != m_byId.end() && byId->second == dentry)
+	{
+		m_byId.erase(byId);
+	}
+	m_dentries.erase(dentry);
+}
+
+void dbc::DentryCache::TrimToCapacity()
+{
+	while (m_dentries.size() > m_capacity)
+	{
+		Erase(std::prev(m_dentries.end()));
+	}
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "TypesInternal.h"
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace dbc
+{
+	class Connection;
+
+	typedef std::unordered_set<int64_t> ElementsIds_st;
+
+	// LRU cache of the directory entries: (parent id, name) -> (id, type). The missing entries are cached too.
+	// The writers invalidate the entries after the changes are committed. The result of the lookup, which was running
+	// while any entry was invalidated, is not cached: it may be read from the database before the change.
+	class DentryCache
+	{
+		NONCOPYABLE(DentryCache);
+
+	public:
+		static const size_t DEFAULT_CAPACITY = 16384;
+
+		struct Dentry
+		{
+			Dentry(int64_t id = 0, ElementType type = ElementTypeUnknown)
+				: id(id), type(type)
+			{ }
+
+			int64_t id; // 0 if the element doesn't exist
+			ElementType type;
+		};
+
+		struct Statistics
+		{
+			Statistics()
+				: hits(0), misses(0), size(0)
+			{ }
+
+			uint64_t hits;
+			uint64_t misses; // Every miss is a query to the database
+			size_t size;
+		};
+
+		explicit DentryCache(size_t capacity = DEFAULT_CAPACITY);
+
+		// Returns false if there is no such element
+		bool Lookup(Connection& connection, int64_t parentId, const std::string& name, Dentry& dentry);
+
+		void Invalidate(int64_t parentId, const std::string& name); // Created, renamed or moved element
+		void InvalidateElement(int64_t id); // Removed element without children
+		void InvalidateElements(const ElementsIds_st& ids); // Removed subtree: the entries of the elements and of their children
+		void Clear();
+
+		void SetCapacity(size_t capacity); // 0 disables caching
+		Statistics GetStatistics();
+
+	private:
+		struct CachedDentry
+		{
+			std::string key;
+			int64_t parentId;
+			Dentry dentry;
+		};
+
+		typedef std::list<CachedDentry> Dentries_lst; // the most recently used is the first
+		typedef std::unordered_map<std::string, Dentries_lst::iterator> DentriesIndex_mp;
+		typedef std::unordered_map<int64_t, Dentries_lst::iterator> DentriesById_mp; // existing elements only
+
+		void Insert(const std::string& key, int64_t parentId, const Dentry& dentry);
+		void Erase(Dentries_lst::iterator dentry);
+		void TrimToCapacity();
+
+	private:
+		std::mutex m_mutex;
+		size_t m_capacity;
+		uint64_t m_generation; // incremented by every invalidation
+		Dentries_lst m_dentries;
+		DentriesIndex_mp m_index;
+		DentriesById_mp m_byId;
+		Statistics m_stats;
+	};
+}
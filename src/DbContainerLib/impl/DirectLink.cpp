@@ -19,6 +19,14 @@ dbc::DirectLink::DirectLink(ContainerResources resources, int64_t id)
 
 dbc::DirectLink::DirectLink(ContainerResources resources, int64_t parentId, const std::string& name)
     : Link(resources, parentId, name)
+	, m_target(s_wrongId)
+{
+    InitTarget();
+}
+
+dbc::DirectLink::DirectLink(ContainerResources resources, const ElementInfo& info)
+    : Link(resources, info)
+	, m_target(s_wrongId)
 {
     InitTarget();
 }
@@ -61,9 +69,9 @@ dbc::Error dbc::DirectLink::IsElementReferenceable(ElementGuard element)
 
 void dbc::DirectLink::InitTarget()
 {
-    if (!m_props.Meta().empty())
+    if (!m_linkTarget.empty())
 	{
-        int64_t targetTmp = utils::StringToNumber<int64_t>(m_props.Meta());
+        int64_t targetTmp = utils::StringToNumber<int64_t>(m_linkTarget);
 		if (targetTmp > 0)
 		{
 			m_target = targetTmp;
@@ -12,9 +12,11 @@
 dbc::Error dbc::Element::s_notFoundError = dbc::Error(ERR_DB_FS, NOT_FOUND);
 
 dbc::Element::Element(ContainerResources resources, int64_t id)
-	: m_resources(resources), m_id(id)
+	: m_resources(resources), m_id(id), m_metaLoaded(false)
 {
-    SQLQuery query(m_resources->GetConnection(), "SELECT parent_id, name, type, created, modified, meta FROM FileSystem WHERE id = ?;");
+	m_generation = m_resources->GetConnection().ChangeGeneration();
+    ReadConnection connection = m_resources->GetReadConnection();
+    SQLQuery query(*connection, "SELECT parent_id, name, type, created, modified, target FROM FileSystem WHERE id = ?;");
 	query.BindInt64(1, id);
 	if (!query.Step()) // SQLITE_DONE or SQLITE_OK, but not SQLITE_ROW, which expected
 	{
@@ -22,15 +24,17 @@ dbc::Element::Element(ContainerResources resources, int64_t id)
 	}
 	m_parentId = query.ColumnInt64(0);
 	query.ColumnText(1, m_name);
-    std::string meta;
-    query.ColumnText(5, meta);
-    InitElementInfo(query.ColumnInt(2), query.ColumnInt64(3), query.ColumnInt64(4), meta);
+    std::string linkTarget;
+    query.ColumnText(5, linkTarget);
+    InitElementInfo(query.ColumnInt(2), query.ColumnInt64(3), query.ColumnInt64(4), linkTarget);
 }
 
 dbc::Element::Element(ContainerResources resources, int64_t parent_id, const std::string& name)
-	: m_resources(resources), m_parentId(parent_id), m_name(name)
+	: m_resources(resources), m_parentId(parent_id), m_name(name), m_metaLoaded(false)
 {
-    SQLQuery query(m_resources->GetConnection(), "SELECT id, type, created, modified, meta FROM FileSystem WHERE parent_id = ? AND name = ?;");
+	m_generation = m_resources->GetConnection().ChangeGeneration();
+    ReadConnection connection = m_resources->GetReadConnection();
+    SQLQuery query(*connection, "SELECT id, type, created, modified, target FROM FileSystem WHERE parent_id = ? AND name = ?;");
 	query.BindInt64(1, parent_id);
 	query.BindText(2, name);
 	if (!query.Step()) // SQLITE_DONE or SQLITE_OK, but not SQLITE_ROW, which expected
@@ -38,9 +42,15 @@ dbc::Element::Element(ContainerResources resources, int64_t parent_id, const std
 		throw ContainerException(s_notFoundError);
 	}
 	m_id = query.ColumnInt64(0);
-    std::string meta;
-    query.ColumnText(4, meta);
-    InitElementInfo(query.ColumnInt(1), query.ColumnInt64(2), query.ColumnInt64(3), meta);
+    std::string linkTarget;
+    query.ColumnText(4, linkTarget);
+    InitElementInfo(query.ColumnInt(1), query.ColumnInt64(2), query.ColumnInt64(3), linkTarget);
+}
+
+dbc::Element::Element(ContainerResources resources, const ElementInfo& info)
+	: m_resources(resources), m_id(info.ID), m_parentId(info.ParentID), m_name(info.Name), m_metaLoaded(false), m_generation(info.Generation)
+{
+	InitElementInfo(info.Type, info.Created, info.Modified, info.Target);
 }
 
 bool dbc::Element::Exists()
@@ -52,6 +62,7 @@ std::string dbc::Element::Name()
 {
 	Refresh();
 
+	MutexLock lock(m_rowMutex);
 	return m_name;
 }
 
@@ -62,30 +73,31 @@ std::string dbc::Element::Path()
 
 	std::string out;
 
-	SQLQuery query(m_resources->GetConnection(), "SELECT count(*), name, parent_id FROM FileSystem WHERE id = ?;");
-
-	for (int64_t id = m_id, parentId = m_parentId; id > 0; id = parentId, query.Reset())
+	// All ancestors from the root, the element itself is the last one
+	ReadConnection connection = m_resources->GetReadConnection();
+	SQLQuery query(*connection, "SELECT FileSystem.name FROM FileSystemTree JOIN FileSystem ON FileSystem.id = FileSystemTree.ancestor_id "
+		"WHERE FileSystemTree.descendant_id = ? ORDER BY FileSystemTree.depth DESC;");
+	query.BindInt64(1, m_id);
+	while (query.Step())
 	{
 		std::string tmp_name;
-		query.BindInt64(1, id);
-		query.Step();
-		int count = query.ColumnInt(0);
-		if (count == 0)
-		{
-			throw ContainerException(ERR_DB, NOT_VALID, s_notFoundError);
-		}
-		query.ColumnText(1, tmp_name);
-		parentId = query.ColumnInt64(2);
-		tmp_name = dbc::utils::SlashedPath(tmp_name);
-		std::reverse(tmp_name.begin(), tmp_name.end());
-		out.append(tmp_name.cbegin(), tmp_name.cend());
+		query.ColumnText(0, tmp_name);
+		out.append(dbc::utils::SlashedPath(tmp_name));
+	}
+	if (out.empty())
+	{
+		throw ContainerException(ERR_DB, NOT_VALID, s_notFoundError);
 	}
 
-	std::reverse(out.begin(), out.end());
 	out.pop_back(); // remove last slash
 	return out;
 }
 
+int64_t dbc::Element::Id() const
+{
+	return m_id;
+}
+
 dbc::ElementType dbc::Element::Type() const
 {
 	return m_type;
@@ -142,22 +154,12 @@ bool dbc::Element::IsChildOf(const Element& obj)
 		return true;
 	}
 
-	int64_t id = m_id;
-	int64_t parentId = m_parentId;
-	SQLQuery query(m_resources->GetConnection(), "SELECT parent_id FROM FileSystem WHERE id = ?;");
-	while (parentId > 0)
-	{
-		query.Reset();
-		query.BindInt64(1, id);
-		query.Step();
-		parentId = query.ColumnInt64(0);
-		if (parentId == targetId)
-		{
-			return true;
-		}
-		id = parentId;
-	}
-	return false;
+	ReadConnection connection = m_resources->GetReadConnection();
+	SQLQuery query(*connection, "SELECT count(*) FROM FileSystemTree WHERE ancestor_id = ? AND descendant_id = ?;");
+	query.BindInt64(1, targetId);
+	query.BindInt64(2, m_id);
+	query.Step();
+	return query.ColumnInt(0) != 0;
 }
 
 dbc::FolderGuard dbc::Element::GetParentEntry()
@@ -167,7 +169,7 @@ dbc::FolderGuard dbc::Element::GetParentEntry()
 		throw ContainerException(s_notFoundError);
 	}
 
-	return FolderGuard(new Folder(m_resources, m_parentId));
+	return std::static_pointer_cast<Folder>(m_resources->GetContainer().CreateElementObject(m_parentId, ElementTypeFolder));
 }
 
 void dbc::Element::MoveToEntry(Folder& newParent)
@@ -196,6 +198,9 @@ void dbc::Element::MoveToEntry(Folder& newParent)
 		query.BindInt64(1, elementObj.m_id);
 		query.BindInt64(2, m_id);
 		query.Step();
+		// The entries of the children are not changed: they are bound to the id of this element
+		m_resources->GetDentries().Invalidate(m_parentId, m_name);
+		m_resources->GetDentries().Invalidate(elementObj.m_id, m_name);
         UpdateModifiedAndMetaData();
 	}
 	catch (const ContainerException& ex)
@@ -209,6 +214,9 @@ void dbc::Element::Remove()
 	SQLQuery query(m_resources->GetConnection(), "DELETE FROM FileSystem WHERE id = ?;");
 	query.BindInt64(1, m_id);
 	query.Step();
+
+	m_resources->GetDentries().InvalidateElement(m_id);
+	m_resources->GetIdentityMap().Erase(m_id);
 }
 
 void dbc::Element::Rename(const std::string& newName)
@@ -233,15 +241,20 @@ void dbc::Element::Rename(const std::string& newName)
 	query.BindText(1, newName);
 	query.BindInt64(2, m_id);
 	query.Step();
+	m_resources->GetDentries().Invalidate(m_parentId, m_name);
+	m_resources->GetDentries().Invalidate(m_parentId, newName);
 
     UpdateModifiedAndMetaData();
 
+	MutexLock lock(m_rowMutex);
 	m_name = newName;
 }
 
 dbc::ElementProperties dbc::Element::GetProperties()
 {
 	Refresh();
+	LoadMeta();
+	MutexLock lock(m_rowMutex);
     return m_props;
 }
 
@@ -253,23 +266,40 @@ void dbc::Element::SetMetaInformation(const std::string& meta)
 
 void dbc::Element::Refresh()
 {
-    SQLQuery query(m_resources->GetConnection(), "SELECT parent_id, name, modified, meta FROM FileSystem WHERE id = ?;");
+	uint64_t generation = m_resources->GetConnection().ChangeGeneration();
+	{
+		MutexLock lock(m_rowMutex);
+		if (generation != 0 && generation == m_generation)
+		{
+			return;
+		}
+	}
+
+    ReadConnection connection = m_resources->GetReadConnection();
+    SQLQuery query(*connection, "SELECT parent_id, name, modified, target FROM FileSystem WHERE id = ?;");
 	query.BindInt64(1, m_id);
 	if (!query.Step())
 	{
 		throw ContainerException(s_notFoundError);
 	}
+	std::string name;
+	query.ColumnText(1, name);
+    std::string linkTarget;
+    query.ColumnText(3, linkTarget);
+
+	MutexLock lock(m_rowMutex);
 	m_parentId = query.ColumnInt64(0);
-	query.ColumnText(1, m_name);
+	m_name = name;
     m_props.SetDateModified(query.ColumnInt64(2));
-    std::string meta;
-    query.ColumnText(3, meta);
-    m_props.SetMeta(meta);
+	m_linkTarget = linkTarget;
+	m_metaLoaded = false;
+	m_generation = generation;
 }
 
 bool dbc::Element::Exists(int64_t id)
 {
-	SQLQuery query(m_resources->GetConnection(), "SELECT count(*) FROM FileSystem WHERE id = ?;");
+	ReadConnection connection = m_resources->GetReadConnection();
+	SQLQuery query(*connection, "SELECT count(*) FROM FileSystem WHERE id = ?;");
 	query.BindInt64(1, id);
 	query.Step();
 	int count = query.ColumnInt(0);
@@ -280,10 +310,9 @@ dbc::Error dbc::Element::Exists(int64_t parent_id, std::string name)
 {
 	try
 	{
-		SQLQuery query(m_resources->GetConnection(), "SELECT id FROM FileSystem WHERE parent_id = ? AND name = ?;");
-		query.BindInt64(1, parent_id);
-		query.BindText(2, name);
-		return query.Step() ? SUCCESS : s_notFoundError;
+		ReadConnection connection = m_resources->GetReadConnection();
+		DentryCache::Dentry dentry;
+		return m_resources->GetDentries().Lookup(*connection, parent_id, name, dentry) ? SUCCESS : s_notFoundError;
 	}
 	catch (const ContainerException& ex)
 	{
@@ -293,23 +322,76 @@ dbc::Error dbc::Element::Exists(int64_t parent_id, std::string name)
 
 void dbc::Element::UpdateModifiedAndMetaData(const char* meta /*= nullptr*/)
 {
-    m_props.SetDateModified(::time(0));
-    SQLQuery query(m_resources->GetConnection());
+    ElementProperties props(0, ::time(0));
+    Connection& connection = m_resources->GetConnection();
+    TransactionGuard transaction = connection.StartTransaction();
+    SQLQuery query(connection, "UPDATE FileSystem SET modified = ? WHERE id = ?;");
+    query.BindInt64(1, props.DateModified());
+    query.BindInt64(2, m_id);
+    query.Step();
     if (meta != nullptr)
     {
-        m_props.SetMeta(meta);
-        query.Prepare("UPDATE FileSystem SET modified = ?, meta = ? WHERE id = ?;");
-        query.BindInt64(1, m_props.DateModified());
-        query.BindText(2, m_props.Meta());
-        query.BindInt64(3, m_id);
+        props.SetMeta(meta); // Truncates it
+        if (props.Meta().empty())
+        {
+            query.Prepare("DELETE FROM ElementsMeta WHERE element_id = ?;");
+            query.BindInt64(1, m_id);
+        }
+        else
+        {
+            query.Prepare("INSERT OR REPLACE INTO ElementsMeta(element_id, meta) VALUES (?, ?);");
+            query.BindInt64(1, m_id);
+            query.BindText(2, props.Meta());
+        }
+        query.Step();
     }
-    else
+    transaction->Commit();
+
+	MutexLock lock(m_rowMutex);
+    m_props.SetDateModified(props.DateModified());
+    if (meta != nullptr)
     {
-        query.Prepare("UPDATE FileSystem SET modified = ? WHERE id = ?;");
-        query.BindInt64(1, m_props.DateModified());
-        query.BindInt64(2, m_id);
+        m_props.SetMeta(props.Meta());
+        m_metaLoaded = true;
     }
+}
+
+void dbc::Element::UpdateLinkTarget(const std::string& target)
+{
+    time_t modified = ::time(0);
+    SQLQuery query(m_resources->GetConnection(), "UPDATE FileSystem SET modified = ?, target = ? WHERE id = ?;");
+    query.BindInt64(1, modified);
+    query.BindText(2, target);
+    query.BindInt64(3, m_id);
     query.Step();
+
+	MutexLock lock(m_rowMutex);
+    m_props.SetDateModified(modified);
+    m_linkTarget = target;
+}
+
+void dbc::Element::LoadMeta()
+{
+	{
+		MutexLock lock(m_rowMutex);
+		if (m_metaLoaded)
+		{
+			return;
+		}
+	}
+
+	ReadConnection connection = m_resources->GetReadConnection();
+	SQLQuery query(*connection, "SELECT meta FROM ElementsMeta WHERE element_id = ?;");
+	query.BindInt64(1, m_id);
+	std::string meta;
+	if (query.Step())
+	{
+		query.ColumnText(0, meta);
+	}
+
+	MutexLock lock(m_rowMutex);
+	m_props.SetMeta(meta);
+	m_metaLoaded = true;
 }
 
 int64_t dbc::Element::GetId(const Element& element)
@@ -317,12 +399,13 @@ int64_t dbc::Element::GetId(const Element& element)
 	return element.m_id;
 }
 
-void dbc::Element::InitElementInfo(int type, int64_t created, int64_t modified, const std::string& meta)
+void dbc::Element::InitElementInfo(int type, int64_t created, int64_t modified, const std::string& linkTarget)
 {
     m_type = static_cast<ElementType>(type);
 	if (m_type == ElementTypeUnknown)
 	{
 		throw ContainerException(ERR_DB_FS, CANT_OPEN, ERR_DB, IS_DAMAGED);
 	}
-    m_props = ElementProperties(created, modified, meta);
+    m_props = ElementProperties(created, modified);
+	m_linkTarget = linkTarget;
 }
@@ -0,0 +1,94 @@
+#include "stdafx.h"
+#include "ElementsIdentityMap.h"
+
+namespace
+{
+	const size_t s_minPurgeSize = 1024;
+}
+
+dbc::ElementsIdentityMap::ElementsIdentityMap()
+	: m_purgeSize(s_minPurgeSize)
+{ }
+
+dbc::ElementGuard dbc::ElementsIdentityMap::Find(int64_t id, ElementType type)
+{
+	MutexLock lock(m_mutex);
+	Elements_mp::iterator found = m_elements.find(id);
+	if (found == m_elements.end())
+	{
+		return ElementGuard();
+	}
+
+	ElementGuard element = found->second.lock();
+	if (!element)
+	{
+		m_elements.erase(found);
+		return ElementGuard();
+	}
+	// The id of the removed element may be reused by an element of another type
+	return element->Type() == type ? element : ElementGuard();
+}
+
+dbc::ElementGuard dbc::ElementsIdentityMap::Insert(ElementGuard element)
+{
+	MutexLock lock(m_mutex);
+	std::weak_ptr<Element>& entry = m_elements[element->m_id];
+	ElementGuard existing = entry.lock();
+	if (existing && existing->Type() == element->Type())
+	{
+		return existing; // Other thread has created the object of the same element
+	}
+
+	entry = element;
+	if (m_elements.size() >= m_purgeSize)
+	{
+		PurgeExpired();
+	}
+	return element;
+}
+
+void dbc::ElementsIdentityMap::Erase(int64_t id)
+{
+	MutexLock lock(m_mutex);
+	m_elements.erase(id);
+}
+
+void dbc::ElementsIdentityMap::Erase(const ElementsIds_st& ids)
+{
+	MutexLock lock(m_mutex);
+	for (int64_t id : ids)
+	{
+		m_elements.erase(id);
+	}
+}
+
+void dbc::ElementsIdentityMap::Clear()
+{
+	MutexLock lock(m_mutex);
+	m_elements.clear();
+	m_purgeSize = s_minPurgeSize;
+}
+
+size_t dbc::ElementsIdentityMap::Size()
+{
+	MutexLock lock(m_mutex);
+	PurgeExpired();
+	return m_elements.size();
+}
+
+void dbc::ElementsIdentityMap::PurgeExpired()
+{
+	for (Elements_mp::iterator itr = m_elements.begin(); itr != m_elements.end();)
+	{
+		if (itr->second.expired())
+		{
+			itr = m_elements.erase(itr);
+		}
+		else
+		{
+			++itr;
+		}
+	}
+	// The purge is repeated when the map doubles, so its cost is amortized by the insertions
+	m_purgeSize = std::max(s_minPurgeSize, m_elements.size() * 2);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "TypesInternal.h"
+#include "DentryCache.h"
+#include "Element.h"
+#include <unordered_map>
+
+namespace dbc
+{
+	// Weak map of the live element objects by their ids. The lookups of an element which is already held somewhere
+	// return the same object, so its loaded row is shared and the changes made through it are seen by every holder.
+	// The map doesn't keep the objects alive: the expired entries are purged while the map grows.
+	class ElementsIdentityMap
+	{
+		NONCOPYABLE(ElementsIdentityMap);
+
+	public:
+		ElementsIdentityMap();
+
+		ElementGuard Find(int64_t id, ElementType type); // nullptr if there is no live object of this type
+		ElementGuard Insert(ElementGuard element); // Returns the live object of the same element, if it was inserted first
+		void Erase(int64_t id); // Removed element, its id may be reused
+		void Erase(const ElementsIds_st& ids);
+		void Clear();
+
+		size_t Size(); // Live objects
+
+	private:
+		typedef std::unordered_map<int64_t, std::weak_ptr<Element>> Elements_mp;
+
+		void PurgeExpired();
+
+	private:
+		std::mutex m_mutex;
+		Elements_mp m_elements;
+		size_t m_purgeSize; // The expired entries are purged when the map grows to this size
+	};
+}
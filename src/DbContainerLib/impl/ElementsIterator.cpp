@@ -10,33 +10,154 @@ using namespace dbc;
 
 namespace
 {
-	void GetChildrenInfo(Connection& connection, int64_t folderId, ElementInfo_vt& out)
+	// The columns of the query must be: id, parent_id, type, name, created, modified, target, data_size
+	void ReadChildrenInfo(SQLQuery& query, uint64_t generation, ElementInfo_vt& out)
 	{
-		assert(out.empty());
-		int64_t tmpId;
-		int64_t tmpParentId;
 		int tmp_type;
-		SQLQuery query(connection, "SELECT id, parent_id, type FROM FileSystem WHERE parent_id = ?;");
-		query.BindInt64(1, folderId);
 		while (query.Step())
 		{
-			tmpId = query.ColumnInt64(0);
-			tmpParentId = query.ColumnInt64(1);
 			tmp_type = query.ColumnInt(2);
 			if (tmp_type == ElementTypeUnknown || tmp_type > ElementTypeDirectLink)
 			{
 				throw dbc::ContainerException(ERR_DB, IS_DAMAGED);
 			}
-			ElementInfo tmp_info(tmpId, tmpParentId, static_cast<ElementType>(tmp_type));
+			ElementInfo tmp_info(query.ColumnInt64(0), query.ColumnInt64(1), static_cast<ElementType>(tmp_type));
+			query.ColumnText(3, tmp_info.Name);
+			tmp_info.Created = query.ColumnInt64(4);
+			tmp_info.Modified = query.ColumnInt64(5);
+			query.ColumnText(6, tmp_info.Target);
+			tmp_info.Size = static_cast<uint64_t>(query.ColumnInt64(7));
+			tmp_info.Generation = generation;
 			out.push_back(tmp_info);
 		}
 	}
+
+	// The smallest string which is greater than all strings with the prefix, empty if there is no such string
+	std::string PrefixUpperBound(std::string prefix)
+	{
+		while (!prefix.empty() && static_cast<unsigned char>(prefix.back()) == 0xff)
+		{
+			prefix.pop_back();
+		}
+		if (!prefix.empty())
+		{
+			prefix.back() = static_cast<char>(static_cast<unsigned char>(prefix.back()) + 1);
+		}
+		return prefix;
+	}
+
+	// Every condition of the filter is pushed into the query. The name prefix (also the literal beginning of the glob)
+	// is a range of names, so it is searched by idx_FileSystem_parent_name like the other conditions by their indexes.
+	void GetChildrenInfo(Connection& connection, int64_t folderId, const ListFilter& filter, uint64_t generation, ElementInfo_vt& out)
+	{
+		assert(out.empty());
+		if (filter.Types() == 0)
+		{
+			return;
+		}
+
+		std::stringstream sql;
+		sql << "SELECT id, parent_id, type, name, created, modified, target, data_size FROM FileSystem WHERE parent_id = ?";
+		if (filter.Types() != ListTypeAll)
+		{
+			sql << " AND type IN (";
+			const char* separator = "";
+			for (int type = ElementTypeFolder; type <= ElementTypeDirectLink; ++type)
+			{
+				if (filter.Types() & (1 << type))
+				{
+					sql << separator << type;
+					separator = ", ";
+				}
+			}
+			sql << ")";
+		}
+
+		std::string prefix;
+		if (filter.NameMatch() == ListNamePrefix)
+		{
+			prefix = filter.NamePattern();
+		}
+		else if (filter.NameMatch() == ListNameGlob)
+		{
+			prefix = filter.NamePattern().substr(0, filter.NamePattern().find_first_of("*?["));
+			sql << " AND name GLOB ?";
+		}
+		std::string prefixEnd = PrefixUpperBound(prefix);
+		if (!prefix.empty())
+		{
+			sql << " AND name >= ?";
+		}
+		if (!prefixEnd.empty())
+		{
+			sql << " AND name < ?";
+		}
+		if (filter.HasModifiedRange())
+		{
+			sql << " AND modified BETWEEN ? AND ?";
+		}
+		if (filter.HasCreatedRange())
+		{
+			sql << " AND created BETWEEN ? AND ?";
+		}
+
+		static const char* s_orders[] = { "", " ORDER BY name", " ORDER BY name DESC", " ORDER BY modified, name", " ORDER BY modified DESC, name DESC",
+			" ORDER BY created, name", " ORDER BY created DESC, name DESC" };
+		sql << s_orders[filter.SortOrder()];
+		if (filter.Limit() != 0)
+		{
+			sql << " LIMIT ?";
+		}
+		sql << ";";
+
+		SQLQuery query(connection, sql.str());
+		int index = 1;
+		query.BindInt64(index++, folderId);
+		if (filter.NameMatch() == ListNameGlob)
+		{
+			query.BindText(index++, filter.NamePattern());
+		}
+		if (!prefix.empty())
+		{
+			query.BindText(index++, prefix);
+		}
+		if (!prefixEnd.empty())
+		{
+			query.BindText(index++, prefixEnd);
+		}
+		if (filter.HasModifiedRange())
+		{
+			query.BindInt64(index++, filter.ModifiedFrom());
+			query.BindInt64(index++, filter.ModifiedTo());
+		}
+		if (filter.HasCreatedRange())
+		{
+			query.BindInt64(index++, filter.CreatedFrom());
+			query.BindInt64(index++, filter.CreatedTo());
+		}
+		if (filter.Limit() != 0)
+		{
+			query.BindInt64(index++, static_cast<int64_t>(filter.Limit()));
+		}
+		ReadChildrenInfo(query, generation, out);
+	}
+
+	ElementGuard CreateListedElement(ContainerResources& resources, const ElementInfo& info)
+	{
+		uint64_t generation = resources->GetConnection().ChangeGeneration();
+		if (generation == 0 || generation != info.Generation) // The element may be already changed or removed, it is loaded again
+		{
+			return resources->GetContainer().CreateElementObject(info.ID, info.Type);
+		}
+		return resources->GetContainer().CreateElementObject(info);
+	}
 }
 
-ElementsIterator::ElementsIterator(ContainerResources resources, int64_t folder_id)
+ElementsIterator::ElementsIterator(ContainerResources resources, int64_t folder_id, const ListFilter& filter)
 	: m_resources(resources), m_folderId(folder_id)
 {
-	GetChildrenInfo(m_resources->GetConnection(), folder_id, m_info);
+	uint64_t generation = m_resources->GetConnection().ChangeGeneration();
+	GetChildrenInfo(*m_resources->GetReadConnection(), folder_id, filter, generation, m_info);
 	m_size = m_info.size();
 }
 
@@ -47,6 +168,77 @@ ElementGuard ElementsIterator::Next()
 		throw ContainerException(WRONG_PARAMETERS);
 	}
 
-	ElementInfo current = m_info[m_current++];
-	return m_resources->GetContainer().CreateElementObject(current.ID, current.Type);
+	return CreateListedElement(m_resources, m_info[m_current++]);
+}
+
+PagedElementsIterator::PagedElementsIterator(ContainerResources resources, int64_t folder_id, size_t pageSize, const std::string& startAfter)
+	: m_folderId(folder_id), m_resources(resources), m_pageSize(pageSize > 0 ? pageSize : 1), m_startAfter(startAfter)
+{
+	Rewind();
+}
+
+bool PagedElementsIterator::HasNext() const
+{
+	return m_pagePosition < m_page.size();
+}
+
+ElementGuard PagedElementsIterator::Next()
+{
+	if (!HasNext())
+	{
+		throw ContainerException(WRONG_PARAMETERS);
+	}
+
+	ElementGuard element = CreateListedElement(m_resources, m_page[m_pagePosition++]);
+	m_lastKey = m_page[m_pagePosition - 1].Name;
+	++m_current;
+	if (m_pagePosition == m_page.size() && !m_lastPage)
+	{
+		FetchPage();
+	}
+	return element;
+}
+
+void PagedElementsIterator::Rewind()
+{
+	m_current = 0;
+	m_lastKey = m_startAfter;
+	m_lastPage = false;
+	FetchPage();
+}
+
+bool PagedElementsIterator::Empty() const
+{
+	return m_current == 0 && m_page.empty();
+}
+
+size_t PagedElementsIterator::Count() const
+{
+	ReadConnection connection = m_resources->GetReadConnection();
+	SQLQuery query(*connection, "SELECT count(*) FROM FileSystem WHERE parent_id = ?;");
+	query.BindInt64(1, m_folderId);
+	query.Step();
+	return static_cast<size_t>(query.ColumnInt64(0));
+}
+
+const std::string& PagedElementsIterator::LastKey() const
+{
+	return m_lastKey;
+}
+
+void PagedElementsIterator::FetchPage()
+{
+	m_page.clear();
+	m_pagePosition = 0;
+
+	uint64_t generation = m_resources->GetConnection().ChangeGeneration();
+	ReadConnection connection = m_resources->GetReadConnection();
+	// The names are never empty, so the first page is the same query
+	SQLQuery query(*connection, "SELECT id, parent_id, type, name, created, modified, target, data_size FROM FileSystem "
+		"WHERE parent_id = ? AND name > ? ORDER BY name LIMIT ?;");
+	query.BindInt64(1, m_folderId);
+	query.BindText(2, m_lastKey);
+	query.BindInt64(3, static_cast<int64_t>(m_pageSize));
+	ReadChildrenInfo(query, generation, m_page);
+	m_lastPage = m_page.size() < m_pageSize;
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "stdafx.h"
 #include "File.h"
+#include "ElementsIterator.h"
 #include "FileStreamsManager.h"
+#include "FileWriter.h"
 #include "Types.h"
 #include "Container.h"
 #include "SQLQuery.h"
@@ -52,16 +54,31 @@ dbc::File::File(ContainerResources resources, int64_t parent_id, const std::stri
 	: Element(resources, parent_id, name), m_access(NoAccess)
 {	}
 
+dbc::File::File(ContainerResources resources, const ElementInfo& info)
+	: Element(resources, info), m_access(NoAccess)
+{	}
+
 void dbc::File::Remove()
 {
 	if (Exists())
 	{
+		TransactionGuard transaction = m_resources->GetConnection().StartTransaction();
 		SQLQuery query(m_resources->GetConnection(), "UPDATE FileStreams SET used = ? WHERE file_id = ?;");
 		query.BindInt(1, 0);
 		query.BindInt64(2, m_id);
 		while (query.Step());
+		m_resources->GetFreeExtents().UpdateFile(m_resources->GetConnection(), m_id);
+		m_resources->GetFreeExtents().Coalesce(m_resources->GetConnection());
+		// While the file is linked with its ancestors
+		query.Prepare("DELETE FROM InlineData WHERE file_id = ?;");
+		query.BindInt64(1, m_id);
+		query.Step();
+		query.Prepare("DELETE FROM FileTails WHERE file_id = ?;");
+		query.BindInt64(1, m_id);
+		query.Step();
 
 		Element::Remove();
+		transaction->Commit();
 	}
 }
 
@@ -120,7 +137,8 @@ uint64_t dbc::File::Size() const
 	}
 	else
 	{
-		SQLQuery query(m_resources->GetConnection(), "SELECT SUM(used) from FileStreams WHERE file_id = ?;");
+		ReadConnection connection = m_resources->GetReadConnection();
+		SQLQuery query(*connection, "SELECT data_size FROM FileSystem WHERE id = ?;");
 		query.BindInt64(1, m_id);
 		query.Step();
 		return query.ColumnInt64(0);
@@ -141,6 +159,10 @@ uint64_t dbc::File::Read(std::ostream& out, uint64_t size, IProgressObserver* ob
 	{
 		size = m_streamsManager->GetSizeUsed();
 	}
+	if (m_streamsManager->GetInlineSize() > 0)
+	{
+		return InlineRead(out, size, observer);
+	}
 
 	ProxyProgressObserver proxyObserver(observer);
 	uint64_t readTotal(0);
@@ -173,6 +195,17 @@ uint64_t dbc::File::Read(std::ostream& out, uint64_t size, IProgressObserver* ob
 		readTotal += read;
 	}
 
+	const TailInfo& tail = m_streamsManager->GetTail();
+	if (tail.size > 0 && readTotal < size)
+	{
+		uint64_t sizeToReadNow = size - readTotal < tail.size ? size - readTotal : tail.size;
+		if (m_resources->Storage().Read(out, tail.start, tail.start + sizeToReadNow) != sizeToReadNow)
+		{
+			throw ContainerException(ERR_DATA, CANT_READ);
+		}
+		readTotal += sizeToReadNow;
+	}
+
 	return readTotal;
 }
 
@@ -185,18 +218,40 @@ uint64_t dbc::File::Write(std::istream& in, uint64_t size, IProgressObserver* ob
 
 	TemporarilyFileOpener openGuard(this, WriteAccess);
 	m_streamsManager->ReloadStreamsInfo();
+	m_streamsManager->ChooseClusterSize(size);
 
 	TransactionGuard transaction = m_resources->GetConnection().StartTransaction();
 	uint64_t writtenTotal = 0;
-	if (m_resources->GetContainer().GetDataUsagePreferences().TransactionalWrite())
+	const DataUsagePreferences& prefs = m_resources->GetContainer().GetDataUsagePreferences();
+	if (size < prefs.InlineDataThreshold())
 	{
-		writtenTotal = TransactionalWrite(in, size, observer);
+		writtenTotal = InlineWrite(in, size, observer);
 	}
 	else
 	{
-		writtenTotal = DirectWrite(in, size, observer);
+		// The last partial cluster is written to the tail block
+		uint64_t tailSize = m_streamsManager->CalculateTailSize(size);
+		if (size == tailSize)
+		{
+			ReleaseStreams();
+		}
+		else if (prefs.TransactionalWrite())
+		{
+			writtenTotal = TransactionalWrite(in, size - tailSize, observer);
+		}
+		else
+		{
+			writtenTotal = DirectWrite(in, size - tailSize, observer);
+		}
+		writtenTotal += m_streamsManager->WriteTail(in, tailSize);
+		m_streamsManager->WriteInlineData(RawData()); // The file has grown over the threshold
+	}
+	if (m_resources->GetFreeExtents().Coalesce(m_resources->GetConnection()) > 0)
+	{
+		m_streamsManager->ReloadStreamsInfo(); // The released streams of this file might be merged
 	}
 	transaction->Commit();
+	m_resources->GetContainer().RecordWrite(writtenTotal, m_streamsManager->CountUsedStreams());
 
 	return writtenTotal;
 }
@@ -206,13 +261,24 @@ void dbc::File::Clear()
 	TemporarilyFileOpener openGuard(this, WriteAccess);
 	m_streamsManager->ReloadStreamsInfo();
 
+	TransactionGuard transaction = m_resources->GetConnection().StartTransaction();
 	SQLQuery query(m_resources->GetConnection(), "UPDATE FileStreams SET used = 0 WHERE file_id = ?;");
 	query.BindInt64(1, m_id);
 	query.Step();
+	m_resources->GetFreeExtents().UpdateFile(m_resources->GetConnection(), m_id);
+	m_resources->GetFreeExtents().Coalesce(m_resources->GetConnection());
+	m_streamsManager->WriteInlineData(RawData());
+	m_streamsManager->RemoveTail();
+	transaction->Commit();
 
 	m_streamsManager->ReloadStreamsInfo();
 }
 
+dbc::FileWriterGuard dbc::File::OpenWriter(size_t bufferSize)
+{
+	return std::make_shared<FileWriter>(Clone(), bufferSize);
+}
+
 dbc::File::SpaceUsageInfo dbc::File::GetSpaceUsageInfo()
 {
 	SpaceUsageInfo info;
@@ -289,6 +355,125 @@ uint64_t dbc::File::WriteImpl(std::istream& in, uint64_t size, bool writeOnlyToU
 	return writtenTotal;
 }
 
+uint64_t dbc::File::Append(std::istream& in, uint64_t size)
+{
+	if (!in)
+	{
+		throw ContainerException(ERR_DATA_CANT_OPEN_SRC);
+	}
+
+	TemporarilyFileOpener openGuard(this, WriteAccess);
+	m_streamsManager->ReloadStreamsInfo();
+	if (m_streamsManager->GetInlineSize() > 0)
+	{
+		// The inline data is rewritten together with the appended one, inline or to the streams
+		RawData data;
+		m_streamsManager->ReadInlineData(data);
+		std::stringstream joined;
+		joined.write(reinterpret_cast<const char*>(data.data()), data.size());
+		std::vector<char> appended(static_cast<size_t>(size));
+		in.read(appended.data(), appended.size());
+		joined.write(appended.data(), in.gcount());
+		return Write(joined, data.size() + in.gcount()) - data.size();
+	}
+
+	TransactionGuard transaction = m_resources->GetConnection().StartTransaction();
+	// The current tail is rewritten after the streams together with the appended data
+	std::istream* source = &in;
+	std::stringstream joined;
+	const uint64_t oldTailSize = m_streamsManager->GetTail().size;
+	if (oldTailSize > 0)
+	{
+		const TailInfo& tail = m_streamsManager->GetTail();
+		if (m_resources->Storage().Read(joined, tail.start, tail.start + tail.size) != tail.size)
+		{
+			throw ContainerException(ERR_DATA, CANT_READ);
+		}
+		std::vector<char> appended(static_cast<size_t>(size));
+		in.read(appended.data(), appended.size());
+		joined.write(appended.data(), in.gcount());
+		source = &joined;
+		size = oldTailSize + in.gcount();
+	}
+
+	m_streamsManager->ChooseClusterSize(size);
+	uint64_t tailSize = m_streamsManager->CalculateTailSize(size);
+	try
+	{
+		if (size > tailSize)
+		{
+			m_streamsManager->AllocatePlaceForAppend(size - tailSize);
+		}
+	}
+	catch (const ContainerException& ex)
+	{
+		WriteLog("Unable to allocate place for data: " + ex.FullMessage());
+		throw ContainerException(ERR_DATA, CANT_WRITE, ex.ErrorCode());
+	}
+
+	uint64_t writtenTotal = size > tailSize ? WriteImpl(*source, size - tailSize, true, nullptr) : 0;
+	writtenTotal += m_streamsManager->WriteTail(*source, tailSize);
+	writtenTotal -= oldTailSize;
+	if (m_resources->GetFreeExtents().Coalesce(m_resources->GetConnection()) > 0)
+	{
+		m_streamsManager->ReloadStreamsInfo();
+	}
+	transaction->Commit();
+	m_resources->GetContainer().RecordWrite(writtenTotal, m_streamsManager->CountUsedStreams());
+
+	return writtenTotal;
+}
+
+uint64_t dbc::File::InlineRead(std::ostream& out, uint64_t size, IProgressObserver* observer)
+{
+	RawData data;
+	m_streamsManager->ReadInlineData(data);
+	if (size > data.size())
+	{
+		size = data.size();
+	}
+	out.write(reinterpret_cast<const char*>(data.data()), size);
+	if (!out)
+	{
+		throw ContainerException(ERR_DATA, CANT_WRITE);
+	}
+	if (observer != nullptr)
+	{
+		observer->OnProgressUpdated(1);
+	}
+	return size;
+}
+
+uint64_t dbc::File::InlineWrite(std::istream& in, uint64_t size, IProgressObserver* observer)
+{
+	RawData data(static_cast<size_t>(size));
+	in.read(reinterpret_cast<char*>(data.data()), data.size());
+	data.resize(static_cast<size_t>(in.gcount()));
+
+	ReleaseStreams();
+	m_streamsManager->RemoveTail();
+	m_streamsManager->WriteInlineData(data);
+
+	if (observer != nullptr)
+	{
+		observer->OnProgressUpdated(1);
+	}
+	return data.size();
+}
+
+void dbc::File::ReleaseStreams()
+{
+	// The streams are released in the same transaction, so their data is kept if it is rolled back
+	SQLQuery query(m_resources->GetConnection(), "UPDATE FileStreams SET used = 0 WHERE file_id = ? AND used != 0;");
+	query.BindInt64(1, m_id);
+	query.Step();
+	if (query.Changes() > 0)
+	{
+		m_resources->GetFreeExtents().UpdateFile(m_resources->GetConnection(), m_id);
+	}
+	m_streamsManager->ReloadStreamsInfo();
+}
+
 void dbc::File::GetSpaceUsageInfoImpl(FileStreamsManager* streamsManager, SpaceUsageInfo& info)
 {
 	const StreamsChain_vt& streams = streamsManager->GetAllStreams();
@@ -5,6 +5,11 @@
 #include "SQLQuery.h"
 #include "ContainerException.h"
 
+namespace
+{
+	const uint64_t s_tailBlockClusters = 16;
+}
+
 dbc::FileStreamsAllocator::FileStreamsAllocator(FileStreamsManager& streamsManager, ContainerResources resources, uint64_t fileId)
 	: m_streamsManager(streamsManager)
 	, m_resources(resources)
@@ -68,6 +73,12 @@ void dbc::FileStreamsAllocator::ReserveExistingStreams(uint64_t requestedSize)
 		query.BindInt64(2, streamWithCustomUsedSpace->id);
 		query.Step();
 	}
+
+	FreeExtentsIndex& freeExtents = m_resources->GetFreeExtents();
+	for (const StreamInfo& stream : allStreams)
+	{
+		freeExtents.Update(stream);
+	}
 }
 
 void dbc::FileStreamsAllocator::AllocateUnusedAndNewStreams(uint64_t sizeRequested)
@@ -101,15 +112,12 @@ bool dbc::FileStreamsAllocator::AllocateOneUnusedStream(uint64_t sizeRequested)
 {
 	uint64_t sizeForOneStream = m_streamsManager.CalculateClusterMultipleSize(sizeRequested);
 
-	SQLQuery query(m_resources->GetConnection(), "SELECT id, file_id, stream_order, start, size, used FROM FileStreams WHERE (used = 0 AND size >= ?) OR (size - used >= ?) ORDER BY size;");
-	query.BindInt64(1, sizeForOneStream);
-	query.BindInt64(2, sizeForOneStream);
-	if (!query.Step())
+	StreamInfo oldStreamInfo;
+	if (!m_resources->GetFreeExtents().FindBestFit(m_resources->GetConnection(), sizeForOneStream, oldStreamInfo))
 	{
 		return false;
 	}
 
-	StreamInfo oldStreamInfo(query.ColumnInt64(0), query.ColumnInt64(1), query.ColumnInt64(2), query.ColumnInt64(3), query.ColumnInt64(4), query.ColumnInt64(5));
 	if (oldStreamInfo.used != 0) // It will be truncated
 	{
 		StreamInfo cuttedStream;
@@ -125,6 +133,7 @@ bool dbc::FileStreamsAllocator::AllocateOneUnusedStream(uint64_t sizeRequested)
 	else // It will be fully reserved
 	{
 		oldStreamInfo.fileId = m_fileId;
+		oldStreamInfo.order = m_streamsManager.MaxOrder() + 1; // It may be the stream of another file
 		oldStreamInfo.used = sizeRequested;
 		m_streamsManager.UpdateStream(oldStreamInfo);
 		m_streamsManager.GetAllStreams().push_back(oldStreamInfo);
@@ -154,17 +163,8 @@ uint64_t dbc::FileStreamsAllocator::AllocateUnusedStreamsFromThisFile(uint64_t s
 
 uint64_t dbc::FileStreamsAllocator::AllocateUnusedStreamsFromAnotherFiles(uint64_t sizeRequested)
 {
-	uint64_t freeSpaceFound(0);
-	StreamsChain_vt streamsToChange;
-	SQLQuery query(m_resources->GetConnection(), "SELECT id, file_id, stream_order, start, size FROM FileStreams WHERE used = 0 AND file_id != ?;");
-	query.BindInt64(1, m_fileId);
-	while (query.Step() && freeSpaceFound < sizeRequested)
-	{
-		StreamInfo foundStream(query.ColumnInt64(0), query.ColumnInt64(1), query.ColumnInt64(2), query.ColumnInt64(3), query.ColumnInt64(4), 0);
-		streamsToChange.push_back(foundStream);
-		freeSpaceFound += foundStream.size;
-	}
-	if (freeSpaceFound == 0)
+	StreamsChain_vt streamsToChange = m_resources->GetFreeExtents().FindFirstFit(m_resources->GetConnection(), sizeRequested, m_fileId);
+	if (streamsToChange.empty())
 	{
 		return 0;
 	}
@@ -201,3 +201,37 @@ void dbc::FileStreamsAllocator::AllocateNewStream(uint64_t sizeRequested)
 
 	m_streamsManager.AppendStream(info);
 }
+
+
+dbc::TailInfo dbc::FileStreamsAllocator::AllocateTail(uint64_t size)
+{
+	assert(size > 0);
+	// The gap before the first tail of the block (or the whole empty block) and the gaps after every tail
+	SQLQuery query(m_resources->GetConnection(), "SELECT id, 0, start FROM TailBlocks "
+		"WHERE IFNULL((SELECT MIN(offset) FROM FileTails WHERE block_id = TailBlocks.id), size) >= ?1 "
+		"UNION ALL SELECT tails.block_id, tails.offset + tails.size, blocks.start FROM FileTails AS tails JOIN TailBlocks AS blocks ON blocks.id = tails.block_id "
+		"WHERE IFNULL((SELECT MIN(next.offset) FROM FileTails AS next WHERE next.block_id = tails.block_id AND next.offset > tails.offset), blocks.size) "
+		"- tails.offset - tails.size >= ?1 LIMIT 1;");
+	query.BindInt64(1, size);
+	if (query.Step())
+	{
+		uint64_t offset = query.ColumnInt64(1);
+		return TailInfo(query.ColumnInt64(0), offset, query.ColumnInt64(2) + offset, size);
+	}
+
+	uint64_t blockSize = m_resources->GetContainer().GetDataUsagePreferences().ClusterSize() * s_tailBlockClusters;
+	if (blockSize < size)
+	{
+		blockSize = m_streamsManager.CalculateClusterMultipleSize(size);
+	}
+	uint64_t begin = 0;
+	if (m_resources->Storage().Append(blockSize, begin) != blockSize)
+	{
+		throw ContainerException(ERR_DATA_CANT_ALLOCATE_SPACE);
+	}
+	query.Prepare("INSERT INTO TailBlocks(start, size) VALUES (?, ?);");
+	query.BindInt64(1, begin);
+	query.BindInt64(2, blockSize);
+	query.Step();
+	return TailInfo(query.LastRowId(), 0, begin, size);
+}
\ No newline at end of file
@@ -14,6 +14,9 @@ namespace dbc
 		// Reserve all available streams for writing to m_allStreams
 		void ReserveExistingStreams(uint64_t requestedSize);
 		void AllocateUnusedAndNewStreams(uint64_t sizeRequested);
+		// Finds the first free gap for the tail in the tail blocks or appends the new block.
+		// The current tail of the file keeps its place, so it isn't overwritten before the transaction is committed.
+		TailInfo AllocateTail(uint64_t size);
 
 	private:
 		// All these functions reserve streams in streams list. If whole process failed you should reload this list.
@@ -15,6 +15,8 @@ dbc::FileStreamsManager::FileStreamsManager(int64_t fileId, ContainerResources r
 	, m_allocator(*this, resources, fileId)
 	, m_sizeAvailable(0)
 	, m_sizeUsed(0)
+	, m_inlineSize(0)
+	, m_clusterSize(resources->GetContainer().GetDataUsagePreferences().ClusterSize())
 { }
 
 void dbc::FileStreamsManager::ReloadStreamsInfo()
@@ -23,8 +25,10 @@ void dbc::FileStreamsManager::ReloadStreamsInfo()
 	m_usedStreams.clear();
 	m_sizeAvailable = 0;
 	m_sizeUsed = 0;
+	m_changedStreams.clear(); // Left by the failed allocation, its transaction was rolled back
 
-	SQLQuery query(m_resources->GetConnection(), "SELECT id, stream_order, start, size, used FROM FileStreams WHERE file_id = ? ORDER BY stream_order;");
+	ReadConnection connection = m_resources->GetReadConnection();
+	SQLQuery query(*connection, "SELECT id, stream_order, start, size, used FROM FileStreams WHERE file_id = ? ORDER BY stream_order;");
 	query.BindInt64(1, m_fileId);
 	while (query.Step())
 	{
@@ -33,6 +37,15 @@ void dbc::FileStreamsManager::ReloadStreamsInfo()
 		m_sizeAvailable += info.size;
 		m_sizeUsed += info.used;
 	}
+
+	query.Prepare("SELECT size FROM InlineData WHERE file_id = ?;");
+	query.BindInt64(1, m_fileId);
+	m_inlineSize = query.Step() ? query.ColumnInt64(0) : 0;
+
+	query.Prepare("SELECT FileTails.block_id, FileTails.offset, TailBlocks.start, FileTails.size FROM FileTails "
+		"JOIN TailBlocks ON TailBlocks.id = FileTails.block_id WHERE FileTails.file_id = ?;");
+	query.BindInt64(1, m_fileId);
+	m_tail = query.Step() ? TailInfo(query.ColumnInt64(0), query.ColumnInt64(1), query.ColumnInt64(2) + query.ColumnInt64(1), query.ColumnInt64(3)) : TailInfo();
 }
 
 dbc::StreamsChain_vt& dbc::FileStreamsManager::GetAllStreams()
@@ -52,7 +65,107 @@ uint64_t dbc::FileStreamsManager::GetSizeAvailable() const
 
 uint64_t dbc::FileStreamsManager::GetSizeUsed() const
 {
-	return m_sizeUsed;
+	return m_sizeUsed + m_inlineSize + m_tail.size;
+}
+
+uint64_t dbc::FileStreamsManager::GetInlineSize() const
+{
+	return m_inlineSize;
+}
+
+const dbc::TailInfo& dbc::FileStreamsManager::GetTail() const
+{
+	return m_tail;
+}
+
+void dbc::FileStreamsManager::ReadInlineData(RawData& data)
+{
+	data.clear();
+	ReadConnection connection = m_resources->GetReadConnection();
+	SQLQuery query(*connection, "SELECT data FROM InlineData WHERE file_id = ?;");
+	query.BindInt64(1, m_fileId);
+	if (query.Step())
+	{
+		RawData encrypted;
+		query.ColumnBlob(0, encrypted);
+		m_resources->Storage().Decrypt(encrypted, data);
+	}
+	if (data.size() != m_inlineSize)
+	{
+		throw ContainerException(ERR_DATA, IS_DAMAGED);
+	}
+}
+
+void dbc::FileStreamsManager::WriteInlineData(const RawData& data)
+{
+	// REPLACE would not run the delete trigger, which updates the sizes
+	SQLQuery query(m_resources->GetConnection(), "DELETE FROM InlineData WHERE file_id = ?;");
+	query.BindInt64(1, m_fileId);
+	query.Step();
+	m_inlineSize = 0;
+	if (!data.empty())
+	{
+		RawData encrypted;
+		m_resources->Storage().Encrypt(data, encrypted);
+		query.Prepare("INSERT INTO InlineData(file_id, size, data) VALUES (?, ?, ?);");
+		query.BindInt64(1, m_fileId);
+		query.BindInt64(2, data.size());
+		query.BindBlob(3, encrypted);
+		query.Step();
+		m_inlineSize = data.size();
+	}
+}
+
+void dbc::FileStreamsManager::ChooseClusterSize(uint64_t writeSize)
+{
+	m_clusterSize = m_resources->GetContainer().GetDataUsagePreferences().ClusterSizeFor(writeSize);
+}
+
+uint64_t dbc::FileStreamsManager::CalculateTailSize(uint64_t size)
+{
+	return m_resources->GetContainer().GetDataUsagePreferences().TailPacking() ? size % m_clusterSize : 0;
+}
+
+uint64_t dbc::FileStreamsManager::WriteTail(std::istream& in, uint64_t size)
+{
+	if (size == 0)
+	{
+		RemoveTail();
+		return 0;
+	}
+
+	TailInfo tail = m_allocator.AllocateTail(size);
+	tail.size = m_resources->Storage().Write(in, tail.start, tail.start + size);
+	RemoveTail();
+	SQLQuery query(m_resources->GetConnection(), "INSERT INTO FileTails(file_id, block_id, offset, size) VALUES (?, ?, ?, ?);");
+	query.BindInt64(1, m_fileId);
+	query.BindInt64(2, tail.blockId);
+	query.BindInt64(3, tail.offset);
+	query.BindInt64(4, tail.size);
+	query.Step();
+	m_tail = tail;
+	return tail.size;
+}
+
+void dbc::FileStreamsManager::RemoveTail()
+{
+	SQLQuery query(m_resources->GetConnection(), "DELETE FROM FileTails WHERE file_id = ?;");
+	query.BindInt64(1, m_fileId);
+	query.Step();
+	m_tail = TailInfo();
+}
+
+size_t dbc::FileStreamsManager::CountUsedStreams() const
+{
+	size_t count = 0;
+	for (const StreamInfo& stream : m_allStreams)
+	{
+		if (stream.used)
+		{
+			++count;
+		}
+	}
+	return count;
 }
 
 uint64_t dbc::FileStreamsManager::MaxOrder()
@@ -69,20 +182,18 @@ uint64_t dbc::FileStreamsManager::MaxOrder()
 
 uint64_t dbc::FileStreamsManager::CalculateClusterMultipleSize(uint64_t sizeRequested)
 {
-	uint64_t clusterSize = m_resources->GetContainer().GetDataUsagePreferences().ClusterSize();
-	uint64_t ratio = sizeRequested / clusterSize;
-	if (ratio == 0 || sizeRequested % clusterSize > 0)
+	uint64_t ratio = sizeRequested / m_clusterSize;
+	if (ratio == 0 || sizeRequested % m_clusterSize > 0)
 	{
 		++ratio;
 	}
-	return clusterSize * ratio;
+	return m_clusterSize * ratio;
 }
 
 bool dbc::FileStreamsManager::FreeSpaceMeetsFragmentationLevelRequirements(uint64_t freeSpace)
 {
 	return utils::FreeSpaceMeetsFragmentationLevelRequirements(freeSpace,
-		m_resources->GetContainer().GetDataUsagePreferences().FragmentationLevel(),
-		m_resources->GetContainer().GetDataUsagePreferences().ClusterSize());
+		m_resources->GetContainer().GetDataUsagePreferences().FragmentationLevel(), m_clusterSize);
 }
 
 void dbc::FileStreamsManager::AppendStream(const StreamInfo& info)
@@ -99,20 +210,38 @@ void dbc::FileStreamsManager::AppendStream(const StreamInfo& info)
 	query.BindInt64(5, newAppendedStream.used);
 	query.Step();
 	newAppendedStream.id = query.LastRowId();
+	m_resources->GetFreeExtents().Update(newAppendedStream);
 
 	m_allStreams.push_back(newAppendedStream);
 }
 
 void dbc::FileStreamsManager::UpdateStream(const dbc::StreamInfo& info)
 {
+	m_changedStreams[info.id] = info;
+	m_resources->GetFreeExtents().Update(info);
+}
+
+void dbc::FileStreamsManager::SaveChangedStreams()
+{
+	if (m_changedStreams.empty())
+	{
+		return;
+	}
+
 	dbc::SQLQuery query(m_resources->GetConnection(), "UPDATE FileStreams SET file_id = ?, stream_order = ?, start = ?, size = ?, used = ? WHERE id = ?;");
-	query.BindInt64(1, info.fileId);
-	query.BindInt64(2, info.order);
-	query.BindInt64(3, info.start);
-	query.BindInt64(4, info.size);
-	query.BindInt64(5, info.used);
-	query.BindInt64(6, info.id);
-	query.Step();
+	for (const auto& changed : m_changedStreams)
+	{
+		const StreamInfo& info = changed.second;
+		query.BindInt64(1, info.fileId);
+		query.BindInt64(2, info.order);
+		query.BindInt64(3, info.start);
+		query.BindInt64(4, info.size);
+		query.BindInt64(5, info.used);
+		query.BindInt64(6, info.id);
+		query.Step();
+		query.Reset();
+	}
+	m_changedStreams.clear();
 }
 
 bool dbc::FileStreamsManager::CutOffPartOfUsedStream(const StreamInfo& originalStream, uint64_t sizeRequested, StreamInfo& cuttedPart)
@@ -146,6 +275,7 @@ void dbc::FileStreamsManager::AllocatePlaceForDirectWrite(uint64_t size)
 		return;
 	}
 	m_allocator.AllocateUnusedAndNewStreams(size - m_sizeAvailable);
+	SaveChangedStreams();
 	UpdateSizes();
 }
 
@@ -153,28 +283,63 @@ void dbc::FileStreamsManager::AllocatePlaceForTransactionalWrite(uint64_t size)
 {
 	SaveUsedStreams();
 	m_allocator.AllocateUnusedAndNewStreams(size);
+	SaveChangedStreams();
 }
 
 void dbc::FileStreamsManager::DeallocatePlaceAfterTransactionalWrite()
 {
 	if (!m_usedStreams.empty())
 	{
-		SQLQuery query(m_resources->GetConnection());
 		auto allStreamsEnd = m_allStreams.end();
 		for (auto stream = m_allStreams.begin(); stream != allStreamsEnd; ++stream)
 		{
 			if (m_usedStreams.find(stream->id) != m_usedStreams.end())
 			{
-				query.Prepare("UPDATE FileStreams SET used = 0 WHERE id = ?;");
-				query.BindInt64(1, stream->id);
-				query.Step();
 				stream->used = 0;
+				UpdateStream(*stream);
 			}
 		}
+		SaveChangedStreams();
 		UpdateSizes();
 	}
 }
 
+void dbc::FileStreamsManager::AllocatePlaceForAppend(uint64_t size)
+{
+	SaveUsedStreams();
+	StreamsChain_vt reordered;
+	reordered.reserve(m_allStreams.size());
+	for (const StreamInfo& stream : m_allStreams)
+	{
+		if (stream.used != 0)
+		{
+			reordered.push_back(stream);
+		}
+	}
+	uint64_t order = reordered.empty() ? s_minStreamOrder : reordered.back().order;
+	for (const StreamInfo& stream : m_allStreams)
+	{
+		if (stream.used == 0)
+		{
+			reordered.push_back(stream);
+			if (stream.order <= order)
+			{
+				reordered.back().order = ++order;
+				UpdateStream(reordered.back());
+			}
+			else
+			{
+				order = stream.order;
+			}
+		}
+	}
+	m_allStreams.swap(reordered);
+
+	m_allocator.AllocateUnusedAndNewStreams(size);
+	SaveChangedStreams();
+	UpdateSizes();
+}
+
 void dbc::FileStreamsManager::SaveUsedStreams()
 {
 	m_usedStreams.clear();
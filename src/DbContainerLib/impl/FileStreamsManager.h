@@ -15,14 +15,30 @@ namespace dbc
 		const StreamsIds_st& GetSavedStreams() const;
 
 		uint64_t GetSizeAvailable() const;
-		uint64_t GetSizeUsed() const;
+		uint64_t GetSizeUsed() const; // Including the inline data and the tail
+		uint64_t GetInlineSize() const; // The data stored in InlineData instead of the streams
+		const TailInfo& GetTail() const; // The data after the streams, see DataUsagePreferences::TailPacking()
 
+		void ReadInlineData(RawData& data);
+		// Replaces the inline data in the current transaction. The empty data removes it.
+		void WriteInlineData(const RawData& data);
+
+		// The allocation granularity of the next write, see DataUsagePreferences::ClusterSizeFor()
+		void ChooseClusterSize(uint64_t writeSize);
+		uint64_t CalculateTailSize(uint64_t size); // The part of the size which is stored in the tail block
+		// Writes the new tail and removes the current one in the current transaction. The size 0 only removes it.
+		uint64_t WriteTail(std::istream& in, uint64_t size);
+		void RemoveTail();
+
+		size_t CountUsedStreams() const;
 		uint64_t MaxOrder();
 		uint64_t CalculateClusterMultipleSize(uint64_t sizeRequested);
 		bool FreeSpaceMeetsFragmentationLevelRequirements(uint64_t freeSpace);
 
 		void AppendStream(const StreamInfo& info);
+		// The changed streams are saved to FileStreams by SaveChangedStreams(), the free extents index is updated at once
 		void UpdateStream(const StreamInfo& info);
+		void SaveChangedStreams(); // By one reused statement in the current transaction
 		bool CutOffPartOfUsedStream(const StreamInfo& originalStream, uint64_t sizeRequested, StreamInfo& cuttedPart);
 
 		// Used for non-transactional write.
@@ -36,6 +52,10 @@ namespace dbc
 		void AllocatePlaceForTransactionalWrite(uint64_t sizeRequested);
 		// Used before finishing transactional write for deallocating previously used streams in m_usedStreams.
 		void DeallocatePlaceAfterTransactionalWrite();
+		// Used for appending to the file. The used streams are saved to m_usedStreams and the unused streams
+		// of the file are moved after them, so the appended data follows the data in the order of the streams.
+		// The appended data starts at the beginning of its streams, because every stream is encrypted from its start.
+		void AllocatePlaceForAppend(uint64_t sizeRequested);
 
 	private:
 		// Used for transactional write.
@@ -51,7 +71,11 @@ namespace dbc
 		
 		StreamsChain_vt m_allStreams;
 		StreamsIds_st m_usedStreams;
+		std::map<int64_t, StreamInfo> m_changedStreams; // by id, the last change of every stream
 		uint64_t m_sizeAvailable;
 		uint64_t m_sizeUsed;
+		uint64_t m_inlineSize;
+		TailInfo m_tail;
+		unsigned int m_clusterSize;
 	};
 }
\ No newline at end of file
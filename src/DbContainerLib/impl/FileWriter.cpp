@@ -0,0 +1,123 @@
+#include "stdafx.h"
+#include "FileWriter.h"
+#include "ContainerException.h"
+#include "Logging.h"
+
+dbc::FileWriter::FileWriter(FileGuard file, size_t bufferSize)
+	: m_file(file)
+	, m_bufferSize(bufferSize > 0 ? bufferSize : DEFAULT_BUFFER_SIZE)
+	, m_flushed(0)
+	, m_closed(false)
+{
+	m_file->Open(WriteAccess);
+	m_buffer.reserve(m_bufferSize);
+}
+
+dbc::FileWriter::~FileWriter()
+{
+	try
+	{
+		Close();
+	}
+	catch (const ContainerException& ex)
+	{
+		WriteLog(ex.FullMessage());
+	}
+	catch (const std::exception& ex)
+	{
+		WriteLog(ex.what());
+	}
+}
+
+void dbc::FileWriter::Write(const char* data, size_t size)
+{
+	if (m_closed)
+	{
+		throw ContainerException(ERR_DB_FS, CANT_WRITE, ACTION_IS_FORBIDDEN);
+	}
+
+	while (size > 0)
+	{
+		size_t portion = m_bufferSize - m_buffer.size();
+		portion = size < portion ? size : portion;
+		m_buffer.append(data, portion);
+		data += portion;
+		size -= portion;
+		if (m_buffer.size() == m_bufferSize && size > 0) // The last chunk may be the end of the file, it is flushed on Close()
+		{
+			Flush();
+		}
+	}
+}
+
+uint64_t dbc::FileWriter::Write(std::istream& in, uint64_t size)
+{
+	if (!in)
+	{
+		throw ContainerException(ERR_DATA_CANT_OPEN_SRC);
+	}
+
+	uint64_t read = 0;
+	std::vector<char> portion(static_cast<size_t>(size < m_bufferSize ? size : m_bufferSize));
+	while (read < size && in)
+	{
+		uint64_t left = size - read;
+		in.read(portion.data(), static_cast<std::streamsize>(left < portion.size() ? left : portion.size()));
+		size_t gcount = static_cast<size_t>(in.gcount());
+		Write(portion.data(), gcount);
+		read += gcount;
+	}
+	return read;
+}
+
+void dbc::FileWriter::Flush()
+{
+	if (m_closed || m_buffer.empty())
+	{
+		return;
+	}
+
+	std::istringstream data(m_buffer);
+	uint64_t written = m_flushed == 0 ? m_file->Write(data, m_buffer.size()) : m_file->Append(data, m_buffer.size());
+	if (written != m_buffer.size())
+	{
+		throw ContainerException(ERR_DATA, CANT_WRITE);
+	}
+	m_flushed += written;
+	m_buffer.clear();
+}
+
+void dbc::FileWriter::Close()
+{
+	if (m_closed)
+	{
+		return;
+	}
+
+	try
+	{
+		if (m_flushed == 0 && m_buffer.empty())
+		{
+			m_file->Clear();
+		}
+		Flush();
+	}
+	catch (...)
+	{
+		m_closed = true;
+		m_file->Close();
+		throw;
+	}
+	m_closed = true;
+	m_file->Close();
+}
+
+bool dbc::FileWriter::IsClosed() const
+{
+	return m_closed;
+}
+
+uint64_t dbc::FileWriter::Written() const
+{
+	return m_flushed + m_buffer.size();
+}
@@ -8,6 +8,27 @@
 #include "CommonUtils.h"
 #include "ContainerException.h"
 
+namespace
+{
+	bool IsLink(dbc::ElementType type)
+	{
+		return type == dbc::ElementTypeSymLink || type == dbc::ElementTypeDirectLink;
+	}
+
+	// The meta of the links is the target, it is kept in FileSystem.target
+	void InsertMeta(dbc::Connection& connection, int64_t id, dbc::ElementType type, const std::string& meta)
+	{
+		if (meta.empty() || IsLink(type))
+		{
+			return;
+		}
+		dbc::SQLQuery query(connection, "INSERT INTO ElementsMeta(element_id, meta) VALUES (?, ?);");
+		query.BindInt64(1, id);
+		query.BindText(2, meta);
+		query.Step();
+	}
+}
+
 dbc::Folder::Folder(ContainerResources resources, int64_t id)
 	: Element(resources, id)
 {	}
@@ -16,6 +37,10 @@ dbc::Folder::Folder(ContainerResources resources, int64_t parent_id, const std::
 	: Element(resources, parent_id, name)
 {	}
 
+dbc::Folder::Folder(ContainerResources resources, const ElementInfo& info)
+	: Element(resources, info)
+{	}
+
 std::string dbc::Folder::Name()
 {
 	if (IsRoot())
@@ -35,14 +60,15 @@ std::string dbc::Folder::Path()
 }
 
 void dbc::Folder::Remove()
+{
+	Remove(nullptr);
+}
+
+void dbc::Folder::Remove(IProgressObserver* observer)
 {
 	if (Exists())
 	{
-		Error err = RemoveFolder(m_id);
-		if (err != SUCCESS)
-		{
-			throw ContainerException(err);
-		}
+		RemoveFolder(m_id, observer);
 	}
 }
 
@@ -76,30 +102,35 @@ bool dbc::Folder::IsRoot() const
 
 bool dbc::Folder::HasChildren()
 {
-	SQLQuery query(m_resources->GetConnection(), "SELECT count(*) FROM FileSystem WHERE parent_id = ? LIMIT 1;");
-	query.BindInt64(1, m_id);
-	query.Step();
-	return query.ColumnInt(0) > 0;
+	return ChildrenCount() > 0;
+}
+
+uint64_t dbc::Folder::ChildrenCount()
+{
+	return ReadAggregate("children");
+}
+
+uint64_t dbc::Folder::DescendantCount()
+{
+	return ReadAggregate("descendants");
+}
+
+uint64_t dbc::Folder::TotalSize()
+{
+	return ReadAggregate("total_size");
 }
 
 dbc::ElementGuard dbc::Folder::GetChild(const std::string& name)
 {
 	Refresh();
 
-	SQLQuery query(m_resources->GetConnection(), "SELECT id, type FROM FileSystem WHERE parent_id = ? AND name = ?;");
-	query.BindInt64(1, m_id);
-	query.BindText(2, name);
-	if (!query.Step())
+	ReadConnection connection = m_resources->GetReadConnection();
+	DentryCache::Dentry dentry;
+	if (!m_resources->GetDentries().Lookup(*connection, m_id, name, dentry))
 	{
 		return ElementGuard(0);
 	}
-	int64_t id = query.ColumnInt64(0);
-	int type = query.ColumnInt(1);
-	if (query.Step()) // There is one more child with the same name in this folder
-	{
-		throw ContainerException(ERR_DB, IS_DAMAGED);
-	}
-	return m_resources->GetContainer().CreateElementObject(id, static_cast<ElementType>(type));
+	return m_resources->GetContainer().CreateElementObject(dentry.id, dentry.type);
 }
 
 dbc::ElementGuard dbc::Folder::CreateChild(const std::string& name, ElementType type, const std::string& meta /*= ""*/)
@@ -111,12 +142,26 @@ dbc::ElementGuard dbc::Folder::CreateChild(const std::string& name, ElementType
 dbc::FolderGuard dbc::Folder::CreateFolder(const std::string& name, const std::string& meta)
 {
     CreateChildEntry(name, ElementTypeFolder, meta);
-	return FolderGuard(new Folder(m_resources, m_id, name));
+	return std::static_pointer_cast<Folder>(m_resources->GetContainer().CreateElementObject(m_id, name, ElementTypeFolder));
 }
 dbc::FileGuard dbc::Folder::CreateFile(const std::string& name, const std::string& meta)
 {
     CreateChildEntry(name, ElementTypeFile, meta);
-	return FileGuard(new File(m_resources, m_id, name));
+	return std::static_pointer_cast<File>(m_resources->GetContainer().CreateElementObject(m_id, name, ElementTypeFile));
+}
+
+dbc::ElementGuards_vt dbc::Folder::CreateChildren(const ChildSpecs_vt& children)
+{
+	ElementInfo_vt created;
+	CreateChildrenEntries(children, created);
+
+	ElementGuards_vt elements;
+	elements.reserve(created.size());
+	for (const ElementInfo& info : created)
+	{
+		elements.push_back(m_resources->GetContainer().CreateElementObject(info));
+	}
+	return elements;
 }
 
 dbc::SymLinkGuard dbc::Folder::CreateSymLink(const std::string& name, const std::string& targetPath)
@@ -127,7 +172,7 @@ dbc::SymLinkGuard dbc::Folder::CreateSymLink(const std::string& name, const std:
 		throw ContainerException(ERR_DB_FS, CANT_CREATE, err);
 	}
     CreateChildEntry(name, ElementTypeSymLink, targetPath);
-	return SymLinkGuard(new SymLink(m_resources, m_id, name));
+	return std::static_pointer_cast<SymLink>(m_resources->GetContainer().CreateElementObject(m_id, name, ElementTypeSymLink));
 }
 
 dbc::DirectLinkGuard dbc::Folder::CreateDirectLink(const std::string& name, const ElementGuard target)
@@ -139,7 +184,7 @@ dbc::DirectLinkGuard dbc::Folder::CreateDirectLink(const std::string& name, cons
 	}
 	std::string targetStr = utils::NumberToString(GetId(*target));
     CreateChildEntry(name, ElementTypeDirectLink, targetStr);
-	return DirectLinkGuard(new DirectLink(m_resources, m_id, name));
+	return std::static_pointer_cast<DirectLink>(m_resources->GetContainer().CreateElementObject(m_id, name, ElementTypeDirectLink));
 }
 
 dbc::DbcElementsIterator dbc::Folder::EnumFsEntries()
@@ -148,41 +193,125 @@ dbc::DbcElementsIterator dbc::Folder::EnumFsEntries()
 	return DbcElementsIterator(new ElementsIterator(m_resources, m_id));
 }
 
-dbc::Error dbc::Folder::RemoveFolder(int64_t folderId)
+dbc::DbcElementsIterator dbc::Folder::EnumFsEntries(const ListFilter& filter)
+{
+	Refresh();
+	return DbcElementsIterator(new ElementsIterator(m_resources, m_id, filter));
+}
+
+dbc::DbcPagedElementsIterator dbc::Folder::EnumFsEntriesPaged(size_t pageSize, const std::string& startAfter)
+{
+	Refresh();
+	return DbcPagedElementsIterator(new PagedElementsIterator(m_resources, m_id, pageSize, startAfter));
+}
+
+dbc::ElementSummaries_vt dbc::Folder::ListWithInfo()
+{
+	Refresh();
+	return m_resources->GetContainer().GetChildrenSummaries(m_id);
+}
+
+uint64_t dbc::Folder::ReadAggregate(const std::string& column)
+{
+	ReadConnection connection = m_resources->GetReadConnection();
+	SQLQuery query(*connection, "SELECT " + column + " FROM FolderAggregates WHERE folder_id = ?;");
+	query.BindInt64(1, m_id);
+	if (!query.Step())
+	{
+		throw ContainerException(s_notFoundError);
+	}
+	return static_cast<uint64_t>(query.ColumnInt64(0));
+}
+
+void dbc::Folder::RemoveFolder(int64_t folderId, IProgressObserver* observer)
 {
 	if (folderId <= 1)
 	{
 		throw ContainerException(ACTION_IS_FORBIDDEN); //  Deleting is forbidden for the root;
 	}
 
-	Error ret = SUCCESS;
+	// The subtree is collected into the temporary table from FileSystemTree,
+	// then the elements and their streams are processed by the ranges of ids to report the progress.
+	const int64_t batchSize = 10000;
+	Connection& connection = m_resources->GetConnection();
 	try
 	{
-		TransactionGuard transaction = m_resources->GetConnection().StartTransaction();
+		TransactionGuard transaction = connection.StartTransaction();
+		connection.ExecQuery("CREATE TEMP TABLE IF NOT EXISTS RemovedElements(id INTEGER PRIMARY KEY NOT NULL);"
+			"DELETE FROM temp.RemovedElements;");
 
-		SQLQuery query(m_resources->GetConnection(), "SELECT id FROM FileSystem WHERE parent_id = ?;");
-		int64_t id;
+		SQLQuery query(connection, "INSERT INTO temp.RemovedElements(id) SELECT descendant_id FROM FileSystemTree WHERE ancestor_id = ?;");
 		query.BindInt64(1, folderId);
-		while (query.Step())
+		query.Step();
+		int64_t total = query.Changes();
+		// The subtree is subtracted from the aggregates of the ancestors at once, then all its links are removed,
+		// so the triggers of FileSystem and FileStreams will find no ancestors to update
+		query.Prepare("UPDATE FolderAggregates SET descendants = descendants - ?, "
+			"total_size = total_size - (SELECT total_size FROM FolderAggregates WHERE folder_id = ?) "
+			"WHERE folder_id IN (SELECT ancestor_id FROM FileSystemTree WHERE descendant_id = ? AND depth > 0);");
+		query.BindInt64(1, total);
+		query.BindInt64(2, folderId);
+		query.BindInt64(3, folderId);
+		query.Step();
+		query.Prepare("DELETE FROM FileSystemTree WHERE descendant_id IN (SELECT id FROM temp.RemovedElements);");
+		query.Step();
+		if (observer != nullptr)
 		{
-			id = query.ColumnInt64(0);
-			ret = RemoveFolder(id);
-			if (ret != SUCCESS)
+			observer->OnInfo(utils::NumberToString(total) + " elements will be removed");
+			observer->OnProgressUpdated(0);
+		}
+
+		SQLQuery freeStreams(connection, "UPDATE FileStreams SET used = 0 WHERE used != 0 AND file_id IN "
+			"(SELECT id FROM temp.RemovedElements WHERE id > ? AND id <= ?);");
+		SQLQuery removeElements(connection, "DELETE FROM FileSystem WHERE id IN (SELECT id FROM temp.RemovedElements WHERE id > ? AND id <= ?);");
+		query.Prepare("SELECT max(id), count(*) FROM (SELECT id FROM temp.RemovedElements WHERE id > ? ORDER BY id LIMIT ?);");
+		int64_t removed = 0;
+		for (int64_t lastId = 0; removed < total; query.Reset(), freeStreams.Reset(), removeElements.Reset())
+		{
+			query.BindInt64(1, lastId);
+			query.BindInt64(2, batchSize);
+			query.Step();
+			int64_t batchEnd = query.ColumnInt64(0);
+			int64_t batchCount = query.ColumnInt64(1);
+			if (batchCount == 0)
 			{
 				break;
 			}
+
+			freeStreams.BindInt64(1, lastId);
+			freeStreams.BindInt64(2, batchEnd);
+			freeStreams.Step();
+			removeElements.BindInt64(1, lastId);
+			removeElements.BindInt64(2, batchEnd);
+			removeElements.Step();
+
+			lastId = batchEnd;
+			removed += batchCount;
+			if (observer != nullptr)
+			{
+				observer->OnProgressUpdated(static_cast<float>(removed) / total);
+			}
 		}
-		query.Prepare("DELETE FROM FileSystem WHERE id = ?;");
-		query.BindInt64(1, folderId);
-		query.Step();
+		query.Prepare("SELECT id, file_id, stream_order, start, size, used FROM FileStreams WHERE file_id IN (SELECT id FROM temp.RemovedElements);");
+		m_resources->GetFreeExtents().Update(query);
+		m_resources->GetFreeExtents().Coalesce(connection);
+		ElementsIds_st removedIds;
+		removedIds.reserve(static_cast<size_t>(total));
+		query.Prepare("SELECT id FROM temp.RemovedElements;");
+		while (query.Step())
+		{
+			removedIds.insert(query.ColumnInt64(0));
+		}
+		connection.ExecQuery("DELETE FROM temp.RemovedElements;");
 
 		transaction->Commit();
+		m_resources->GetDentries().InvalidateElements(removedIds);
+		m_resources->GetIdentityMap().Erase(removedIds);
 	}
-	catch (const ContainerException &ex)
+	catch (const ContainerException& ex)
 	{
-		ret = ex.ErrorCode();
+		throw ContainerException(ERR_DB_FS, CANT_REMOVE, ex.ErrorCode());
 	}
-	return ret;
 }
 
 void dbc::Folder::CreateChildEntry(const std::string& name, ElementType type, const std::string& meta)
@@ -204,7 +333,9 @@ void dbc::Folder::CreateChildEntry(const std::string& name, ElementType type, co
 		throw ContainerException(ERR_DB_FS, CANT_WRITE, tmp);
 	}
 
-    SQLQuery query(m_resources->GetConnection(), "INSERT INTO FileSystem(parent_id, name, type, created, modified, meta) VALUES (?, ?, ?, ?, ?, ?);");
+	Connection& connection = m_resources->GetConnection();
+	TransactionGuard transaction = connection.StartTransaction();
+    SQLQuery query(connection, "INSERT INTO FileSystem(parent_id, name, type, created, modified, target) VALUES (?, ?, ?, ?, ?, ?);");
 	query.BindInt64(1, m_id);
 	query.BindText(2, name);
 	query.BindInt(3, type);
@@ -212,6 +343,97 @@ void dbc::Folder::CreateChildEntry(const std::string& name, ElementType type, co
     props.SetCurrentTime();
     query.BindInt64(4, props.DateCreated());
     query.BindInt64(5, props.DateModified());
-    query.BindText(6, meta);
+    query.BindText(6, IsLink(type) ? meta : "");
 	query.Step();
+	InsertMeta(connection, query.LastRowId(), type, meta);
+	transaction->Commit();
+
+	m_resources->GetDentries().Invalidate(m_id, name);
+}
+
+void dbc::Folder::CreateChildrenEntries(const ChildSpecs_vt& children, ElementInfo_vt& created)
+{
+	assert(created.empty());
+	Refresh();
+
+	std::set<std::string> names;
+	for (const ChildSpec& child : children)
+	{
+		if (child.name.empty() || !dbc::utils::FileNameIsValid(child.name) || child.type == ElementTypeUnknown || child.type == ElementTypeDirectLink)
+		{
+			throw ContainerException(ERR_DB_FS, CANT_CREATE, WRONG_PARAMETERS);
+		}
+		if (child.type == ElementTypeSymLink)
+		{
+			Error err = SymLink::IsTargetPathValid(child.meta);
+			if (err != SUCCESS)
+			{
+				throw ContainerException(ERR_DB_FS, CANT_CREATE, err);
+			}
+		}
+		if (!names.insert(child.name).second) // Duplicate inside the request
+		{
+			throw ContainerException(ERR_DB_FS, CANT_WRITE, ERR_DB_FS, ALREADY_EXISTS);
+		}
+	}
+	if (children.empty())
+	{
+		return;
+	}
+
+	TransactionGuard transaction = m_resources->GetConnection().StartTransaction();
+
+	// The names are checked by chunks: the number of the query parameters is limited by SQLITE_MAX_VARIABLE_NUMBER (999)
+	const size_t chunkSize = 500;
+	for (std::set<std::string>::const_iterator chunkStart = names.begin(); chunkStart != names.end(); )
+	{
+		std::string queryStr("SELECT count(*) FROM FileSystem WHERE parent_id = ? AND name IN (?");
+		std::set<std::string>::const_iterator chunkEnd = chunkStart;
+		size_t count = 1;
+		for (++chunkEnd; chunkEnd != names.end() && count < chunkSize; ++chunkEnd, ++count)
+		{
+			queryStr.append(", ?");
+		}
+		queryStr.append(");");
+
+		SQLQuery query(m_resources->GetConnection(), queryStr);
+		query.BindInt64(1, m_id);
+		int column = 2;
+		for (; chunkStart != chunkEnd; ++chunkStart)
+		{
+			query.BindText(column++, *chunkStart);
+		}
+		query.Step();
+		if (query.ColumnInt(0) != 0)
+		{
+			throw ContainerException(ERR_DB_FS, CANT_WRITE, ERR_DB_FS, ALREADY_EXISTS);
+		}
+	}
+
+	ElementProperties props;
+	props.SetCurrentTime();
+	SQLQuery query(m_resources->GetConnection(), "INSERT INTO FileSystem(parent_id, name, type, created, modified, target) VALUES (?, ?, ?, ?, ?, ?);");
+	created.reserve(children.size());
+	for (const ChildSpec& child : children)
+	{
+		const std::string& target = IsLink(child.type) ? child.meta : "";
+		query.BindInt64(1, m_id);
+		query.BindText(2, child.name);
+		query.BindInt(3, child.type);
+		query.BindInt64(4, props.DateCreated());
+		query.BindInt64(5, props.DateModified());
+		query.BindText(6, target);
+		query.Step();
+		created.push_back(ElementInfo(query.LastRowId(), m_id, child.type, child.name, props.DateCreated(), props.DateModified(), target));
+		InsertMeta(m_resources->GetConnection(), query.LastRowId(), child.type, child.meta);
+		query.Reset();
+	}
+
+	transaction->Commit();
+
+	DentryCache& dentries = m_resources->GetDentries();
+	for (const ChildSpec& child : children)
+	{
+		dentries.Invalidate(m_id, child.name);
+	}
 }
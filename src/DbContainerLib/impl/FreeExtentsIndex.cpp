@@ -0,0 +1,282 @@
+#include "stdafx.h"
+#include "FreeExtentsIndex.h"
+#include "Connection.h"
+#include "SQLQuery.h"
+
+namespace
+{
+	size_t SizeClass(uint64_t size)
+	{
+		size_t sizeClass = 0;
+		while (size >>= 1)
+		{
+			++sizeClass;
+		}
+		return sizeClass;
+	}
+}
+
+dbc::FreeExtentsIndex::FreeExtentsIndex()
+	: m_loaded(false)
+	, m_rollbacks(0)
+{ }
+
+void dbc::FreeExtentsIndex::Load(Connection& connection)
+{
+	MutexLock lock(m_mutex);
+	m_loaded = false;
+	CheckLoaded(connection);
+}
+
+void dbc::FreeExtentsIndex::Invalidate()
+{
+	MutexLock lock(m_mutex);
+	m_loaded = false;
+}
+
+void dbc::FreeExtentsIndex::Update(const StreamInfo& stream)
+{
+	MutexLock lock(m_mutex);
+	if (m_loaded)
+	{
+		Replace(stream);
+	}
+}
+
+void dbc::FreeExtentsIndex::Update(SQLQuery& streams)
+{
+	MutexLock lock(m_mutex);
+	if (m_loaded)
+	{
+		ReadStreams(streams);
+	}
+}
+
+void dbc::FreeExtentsIndex::UpdateFile(Connection& connection, int64_t fileId)
+{
+	MutexLock lock(m_mutex);
+	if (m_loaded)
+	{
+		SQLQuery query(connection, "SELECT id, file_id, stream_order, start, size, used FROM FileStreams WHERE file_id = ?;");
+		query.BindInt64(1, fileId);
+		ReadStreams(query);
+	}
+}
+
+bool dbc::FreeExtentsIndex::FindBestFit(Connection& connection, uint64_t size, StreamInfo& found)
+{
+	MutexLock lock(m_mutex);
+	CheckLoaded(connection);
+
+	// The streams of the size class of the requested size may be smaller than it, the streams of the greater classes are not
+	for (size_t sizeClass = SizeClass(size); sizeClass < BINS_COUNT; ++sizeClass)
+	{
+		Bin_st::const_iterator fit = m_bins[sizeClass].lower_bound(std::make_pair(size, int64_t(0)));
+		if (fit != m_bins[sizeClass].end())
+		{
+			found = m_streams[fit->second];
+			return true;
+		}
+	}
+	return false;
+}
+
+dbc::StreamsChain_vt dbc::FreeExtentsIndex::FindFirstFit(Connection& connection, uint64_t size, int64_t exceptFileId)
+{
+	MutexLock lock(m_mutex);
+	CheckLoaded(connection);
+
+	StreamsChain_vt found;
+	uint64_t foundSize = 0;
+	for (Offsets_mp::const_iterator unused = m_unusedByOffset.begin(); unused != m_unusedByOffset.end() && foundSize < size; ++unused)
+	{
+		const StreamInfo& stream = m_streams[unused->second];
+		if (stream.fileId != exceptFileId)
+		{
+			found.push_back(stream);
+			foundSize += stream.size;
+		}
+	}
+	return found;
+}
+
+size_t dbc::FreeExtentsIndex::Coalesce(Connection& connection)
+{
+	MutexLock lock(m_mutex);
+	CheckLoaded(connection);
+
+	StreamsIds_st released;
+	released.swap(m_released);
+	size_t removed = 0;
+	for (uint64_t id : released)
+	{
+		Streams_mp::const_iterator stream = m_streams.find(static_cast<int64_t>(id));
+		if (stream == m_streams.end() || stream->second.used != 0) // Merged into another one or allocated again
+		{
+			continue;
+		}
+
+		Offsets_mp::iterator first = m_unusedByOffset.find(stream->second.start);
+		if (first == m_unusedByOffset.end())
+		{
+			continue;
+		}
+		while (first != m_unusedByOffset.begin())
+		{
+			Offsets_mp::iterator previous = std::prev(first);
+			const StreamInfo& previousStream = m_streams[previous->second];
+			if (previousStream.start + previousStream.size != first->first)
+			{
+				break;
+			}
+			first = previous;
+		}
+		MergeRun(connection, first, removed);
+	}
+	return removed;
+}
+
+size_t dbc::FreeExtentsIndex::CoalesceAll(Connection& connection)
+{
+	MutexLock lock(m_mutex);
+	CheckLoaded(connection);
+
+	m_released.clear();
+	size_t removed = 0;
+	for (Offsets_mp::iterator first = m_unusedByOffset.begin(); first != m_unusedByOffset.end();)
+	{
+		first = MergeRun(connection, first, removed);
+	}
+	return removed;
+}
+
+dbc::FreeExtentsIndex::Statistics dbc::FreeExtentsIndex::GetStatistics()
+{
+	MutexLock lock(m_mutex);
+	return m_stats;
+}
+
+void dbc::FreeExtentsIndex::CheckLoaded(Connection& connection)
+{
+	uint64_t rollbacks = connection.RollbacksCount();
+	if (m_loaded && m_rollbacks == rollbacks)
+	{
+		return;
+	}
+
+	m_loaded = false;
+	m_streams.clear();
+	for (Bin_st& bin : m_bins)
+	{
+		bin.clear();
+	}
+	m_unusedByOffset.clear();
+	Statistics stats;
+	stats.loads = m_stats.loads + 1;
+	stats.coalesced = m_stats.coalesced;
+	m_stats = stats;
+
+	// Scans the covering index idx_FileStreams_used_size instead of the table
+	SQLQuery query(connection, "SELECT id, file_id, stream_order, start, size, used FROM FileStreams WHERE size > used;");
+	ReadStreams(query);
+	m_released.clear(); // Merged by CoalesceAll() only
+	m_loaded = true;
+	m_rollbacks = rollbacks;
+}
+
+void dbc::FreeExtentsIndex::Insert(const StreamInfo& stream)
+{
+	if (stream.size <= stream.used)
+	{
+		return;
+	}
+
+	uint64_t freeSpace = stream.size - stream.used;
+	m_streams[stream.id] = stream;
+	m_bins[SizeClass(freeSpace)].insert(std::make_pair(freeSpace, stream.id));
+	if (stream.used == 0)
+	{
+		m_unusedByOffset[stream.start] = stream.id;
+		++m_stats.unusedStreams;
+	}
+	++m_stats.streams;
+	m_stats.freeSpace += freeSpace;
+}
+
+void dbc::FreeExtentsIndex::Erase(int64_t id)
+{
+	Streams_mp::iterator stream = m_streams.find(id);
+	if (stream == m_streams.end())
+	{
+		return;
+	}
+
+	uint64_t freeSpace = stream->second.size - stream->second.used;
+	m_bins[SizeClass(freeSpace)].erase(std::make_pair(freeSpace, id));
+	if (stream->second.used == 0)
+	{
+		Offsets_mp::iterator unused = m_unusedByOffset.find(stream->second.start);
+		if (unused != m_unusedByOffset.end() && unused->second == id)
+		{
+			m_unusedByOffset.erase(unused);
+		}
+		--m_stats.unusedStreams;
+	}
+	--m_stats.streams;
+	m_stats.freeSpace -= freeSpace;
+	m_streams.erase(stream);
+}
+
+void dbc::FreeExtentsIndex::Replace(const StreamInfo& stream)
+{
+	Erase(stream.id);
+	Insert(stream);
+	if (stream.used == 0)
+	{
+		m_released.insert(stream.id);
+	}
+}
+
+void dbc::FreeExtentsIndex::ReadStreams(SQLQuery& streams)
+{
+	while (streams.Step())
+	{
+		StreamInfo stream(streams.ColumnInt64(0), streams.ColumnInt64(1), streams.ColumnInt64(2), streams.ColumnInt64(3), streams.ColumnInt64(4), streams.ColumnInt64(5));
+		Replace(stream);
+	}
+}
+
+dbc::FreeExtentsIndex::Offsets_mp::iterator dbc::FreeExtentsIndex::MergeRun(Connection& connection, Offsets_mp::iterator first, size_t& removed)
+{
+	StreamInfo merged = m_streams[first->second];
+	std::vector<int64_t> adjacentIds;
+	Offsets_mp::iterator next = std::next(first);
+	for (; next != m_unusedByOffset.end() && next->first == merged.start + merged.size; ++next)
+	{
+		merged.size += m_streams[next->second].size;
+		adjacentIds.push_back(next->second);
+	}
+	if (adjacentIds.empty())
+	{
+		return next;
+	}
+
+	SQLQuery query(connection, "DELETE FROM FileStreams WHERE id = ?;");
+	for (int64_t id : adjacentIds)
+	{
+		query.BindInt64(1, id);
+		query.Step();
+		query.Reset();
+		Erase(id);
+	}
+	query.Prepare("UPDATE FileStreams SET size = ? WHERE id = ?;");
+	query.BindInt64(1, merged.size);
+	query.BindInt64(2, merged.id);
+	query.Step();
+	Erase(merged.id);
+	Insert(merged); // The iterators of the other streams stay valid
+
+	removed += adjacentIds.size();
+	m_stats.coalesced += adjacentIds.size();
+	return next;
+}
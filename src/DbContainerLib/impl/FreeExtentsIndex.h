@@ -0,0 +1,86 @@
+#pragma once
+#include "TypesInternal.h"
+#include "StreamInfo.h"
+#include <set>
+#include <map>
+#include <unordered_map>
+
+namespace dbc
+{
+	class Connection;
+	class SQLQuery;
+
+	// In-memory index of the free space in FileStreams: the unused streams and the free tails of the used ones.
+	// The streams are binned by the size class (log2) of their free space, so the best fit is found in O(log n),
+	// and the unused streams are mapped by their offsets in the storage, so the first fit walks them from the start.
+	// The index is loaded on Connect. The writers of FileStreams update it in their transactions,
+	// and after any rollback the next lookup reloads it from the database.
+	// The physically adjacent unused streams are found by the offsets map and merged into single rows by Coalesce(),
+	// so the free space doesn't crumble into the streams which are too small for the new data.
+	class FreeExtentsIndex
+	{
+		NONCOPYABLE(FreeExtentsIndex);
+
+	public:
+		struct Statistics
+		{
+			Statistics()
+				: streams(0), unusedStreams(0), freeSpace(0), loads(0), coalesced(0)
+			{ }
+
+			size_t streams; // With the free space
+			size_t unusedStreams;
+			uint64_t freeSpace;
+			uint64_t loads; // Every load reads all the FileStreams rows
+			uint64_t coalesced; // The rows removed by merging
+		};
+
+		FreeExtentsIndex();
+
+		void Load(Connection& connection);
+		void Invalidate(); // The next lookup reloads the index
+
+		void Update(const StreamInfo& stream); // Inserted or changed stream
+		void Update(SQLQuery& streams); // The rows of the changed streams: id, file_id, stream_order, start, size, used
+		void UpdateFile(Connection& connection, int64_t fileId); // All the streams of the file were changed by one query
+
+		// The stream with the smallest free space, which is >= size. Returns false if there is no such stream.
+		bool FindBestFit(Connection& connection, uint64_t size, StreamInfo& found);
+		// The unused streams of the other files in the order of their offsets, until their total size is >= size
+		StreamsChain_vt FindFirstFit(Connection& connection, uint64_t size, int64_t exceptFileId);
+
+		// Merges the unused streams released since the last call with their physically adjacent unused neighbours.
+		// The first stream of every merged run is extended, the others are deleted. Returns the number of deleted rows.
+		// Must be called in the write transaction when the writer doesn't use its loaded streams any more.
+		size_t Coalesce(Connection& connection);
+		// The same for all the unused streams of the container
+		size_t CoalesceAll(Connection& connection);
+
+		Statistics GetStatistics();
+
+	private:
+		static const size_t BINS_COUNT = 64;
+
+		typedef std::unordered_map<int64_t, StreamInfo> Streams_mp; // by id
+		typedef std::set<std::pair<uint64_t, int64_t>> Bin_st; // (free space, id)
+		typedef std::map<uint64_t, int64_t> Offsets_mp; // start -> id of the unused stream
+
+		void CheckLoaded(Connection& connection); // m_mutex must be locked
+		void Insert(const StreamInfo& stream);
+		void Erase(int64_t id);
+		void Replace(const StreamInfo& stream); // Remembers the stream if it was released
+		void ReadStreams(SQLQuery& streams);
+		// Merges the run of the adjacent unused streams, which is started from the first one. Returns the stream after the run.
+		Offsets_mp::iterator MergeRun(Connection& connection, Offsets_mp::iterator first, size_t& removed);
+
+	private:
+		std::mutex m_mutex;
+		bool m_loaded;
+		uint64_t m_rollbacks; // Connection::RollbacksCount() when the index was loaded
+		Streams_mp m_streams;
+		Bin_st m_bins[BINS_COUNT];
+		Offsets_mp m_unusedByOffset;
+		StreamsIds_st m_released; // The unused streams to coalesce
+		Statistics m_stats;
+	};
+}
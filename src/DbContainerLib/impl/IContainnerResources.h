@@ -2,8 +2,12 @@
 #include "ContainerResources.h"
 #include "impl/Container.h"
 #include "impl/Connection.h"
+#include "impl/ReadConnectionsPool.h"
+#include "impl/DentryCache.h"
 #include "IDataStorage.h"
 #include "impl/ElementsSyncKeeper.h"
+#include "impl/ElementsIdentityMap.h"
+#include "impl/FreeExtentsIndex.h"
 
 namespace dbc
 {
@@ -15,7 +19,11 @@ namespace dbc
 		virtual bool ContainerAlive() = 0;
 		virtual Container& GetContainer() = 0;
 		virtual Connection& GetConnection() = 0;
+		virtual ReadConnection GetReadConnection() = 0; // For the queries which don't change the database
 		virtual IDataStorage& Storage() = 0;
+		virtual DentryCache& GetDentries() = 0;
 		virtual ElementsSyncKeeper& GetSync() = 0;
+		virtual ElementsIdentityMap& GetIdentityMap() = 0;
+		virtual FreeExtentsIndex& GetFreeExtents() = 0;
 	};
 }
\ No newline at end of file
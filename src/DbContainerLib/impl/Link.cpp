@@ -1,5 +1,6 @@
 #include "stdafx.h"
 #include "Link.h"
+#include "ElementsIterator.h"
 #include "ContainerException.h"
 
 dbc::Link::Link(dbc::ContainerResources resources, int64_t id)
@@ -10,6 +11,10 @@ dbc::Link::Link(dbc::ContainerResources resources, int64_t parentId, const std::
     : Element(resources, parentId, name)
 { }
 
+dbc::Link::Link(dbc::ContainerResources resources, const ElementInfo& info)
+    : Element(resources, info)
+{ }
+
 dbc::ElementProperties dbc::Link::GetProperties()
 {
     ElementGuard target = Target();
@@ -0,0 +1,114 @@
+#include "stdafx.h"
+#include "ListFilter.h"
+#include <limits>
+
+namespace
+{
+	const time_t s_minTime = std::numeric_limits<time_t>::min();
+	const time_t s_maxTime = std::numeric_limits<time_t>::max();
+}
+
+dbc::ListFilter::ListFilter()
+	: m_types(ListTypeAll)
+	, m_nameMatch(ListNameAny)
+	, m_modifiedFrom(s_minTime)
+	, m_modifiedTo(s_maxTime)
+	, m_createdFrom(s_minTime)
+	, m_createdTo(s_maxTime)
+	, m_sortOrder(ListSortNone)
+	, m_limit(0)
+{ }
+
+unsigned int dbc::ListFilter::Types() const
+{
+	return m_types;
+}
+
+dbc::ListNameMatch dbc::ListFilter::NameMatch() const
+{
+	return m_nameMatch;
+}
+
+const std::string& dbc::ListFilter::NamePattern() const
+{
+	return m_namePattern;
+}
+
+time_t dbc::ListFilter::ModifiedFrom() const
+{
+	return m_modifiedFrom;
+}
+
+time_t dbc::ListFilter::ModifiedTo() const
+{
+	return m_modifiedTo;
+}
+
+time_t dbc::ListFilter::CreatedFrom() const
+{
+	return m_createdFrom;
+}
+
+time_t dbc::ListFilter::CreatedTo() const
+{
+	return m_createdTo;
+}
+
+dbc::ListSortOrder dbc::ListFilter::SortOrder() const
+{
+	return m_sortOrder;
+}
+
+size_t dbc::ListFilter::Limit() const
+{
+	return m_limit;
+}
+
+bool dbc::ListFilter::HasModifiedRange() const
+{
+	return m_modifiedFrom != s_minTime || m_modifiedTo != s_maxTime;
+}
+
+bool dbc::ListFilter::HasCreatedRange() const
+{
+	return m_createdFrom != s_minTime || m_createdTo != s_maxTime;
+}
+
+void dbc::ListFilter::SetTypes(unsigned int types)
+{
+	m_types = types & ListTypeAll;
+}
+
+void dbc::ListFilter::SetNamePrefix(const std::string& prefix)
+{
+	m_nameMatch = prefix.empty() ? ListNameAny : ListNamePrefix;
+	m_namePattern = prefix;
+}
+
+void dbc::ListFilter::SetNameGlob(const std::string& glob)
+{
+	m_nameMatch = glob.empty() ? ListNameAny : ListNameGlob;
+	m_namePattern = glob;
+}
+
+void dbc::ListFilter::SetModifiedRange(time_t from, time_t to)
+{
+	m_modifiedFrom = from;
+	m_modifiedTo = to;
+}
+
+void dbc::ListFilter::SetCreatedRange(time_t from, time_t to)
+{
+	m_createdFrom = from;
+	m_createdTo = to;
+}
+
+void dbc::ListFilter::SetSortOrder(ListSortOrder order)
+{
+	m_sortOrder = order;
+}
+
+void dbc::ListFilter::SetLimit(size_t limit)
+{
+	m_limit = limit;
+}
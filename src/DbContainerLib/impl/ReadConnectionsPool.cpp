@@ -0,0 +1,105 @@
+#include "stdafx.h"
+#include "ReadConnectionsPool.h"
+#include "ContainerException.h"
+#include "Logging.h"
+
+namespace
+{
+	void DoNotDelete(dbc::Connection*)
+	{ }
+}
+
+dbc::ReadConnectionsPool::ReadConnectionsPool(Connection& primary, const std::string& dbPath, const ConnectionOptions& options, size_t capacity)
+	: m_primary(primary)
+	, m_dbPath(dbPath)
+	, m_options(options)
+	, m_capacity(capacity)
+	, m_opened(0)
+{ }
+
+dbc::ReadConnectionsPool::~ReadConnectionsPool()
+{
+	assert(m_opened == m_idle.size() && "Connection is still checked out");
+	for (Connection* connection : m_idle)
+	{
+		delete connection;
+	}
+}
+
+dbc::ReadConnection dbc::ReadConnectionsPool::Checkout()
+{
+	if (m_capacity == 0 || m_primary.InTransaction())
+	{
+		return ReadConnection(&m_primary, DoNotDelete);
+	}
+
+	Connection* connection = nullptr;
+	{
+		MutexLock lock(m_mutex);
+		if (!m_idle.empty())
+		{
+			connection = m_idle.back();
+			m_idle.pop_back();
+		}
+		else if (m_opened < m_capacity)
+		{
+			++m_opened;
+		}
+		else // All connections are busy. Waiting for them may cause a deadlock if the thread already holds one.
+		{
+			return ReadConnection(&m_primary, DoNotDelete);
+		}
+	}
+
+	if (connection == nullptr)
+	{
+		try
+		{
+			connection = OpenConnection();
+		}
+		catch (const ContainerException& ex)
+		{
+			{
+				MutexLock lock(m_mutex);
+				--m_opened;
+			}
+			WriteLog("Unable to open the read connection: " + ex.FullMessage());
+			return ReadConnection(&m_primary, DoNotDelete);
+		}
+	}
+
+	std::shared_ptr<ReadConnectionsPool> pool = shared_from_this();
+	return ReadConnection(connection, [pool](Connection* connection) { pool->Return(connection); });
+}
+
+size_t dbc::ReadConnectionsPool::Capacity() const
+{
+	return m_capacity;
+}
+
+size_t dbc::ReadConnectionsPool::Opened()
+{
+	MutexLock lock(m_mutex);
+	return m_opened;
+}
+
+dbc::Connection* dbc::ReadConnectionsPool::OpenConnection()
+{
+	std::unique_ptr<Connection> connection(new Connection(m_dbPath, false, true));
+
+	// Journal mode and auto-vacuum are the properties of the database, they are set by the primary connection
+	std::stringstream pragmas;
+	pragmas << "PRAGMA cache_size = -" << m_options.CacheSizeKb() << ";";
+	pragmas << "PRAGMA mmap_size = " << m_options.MmapSize() << ";";
+	pragmas << "PRAGMA temp_store = " << static_cast<int>(m_options.TempStore()) << ";";
+	connection->ExecQuery(pragmas.str());
+	connection->Statements().SetCapacity(m_options.StatementsCacheSize());
+
+	return connection.release();
+}
+
+void dbc::ReadConnectionsPool::Return(Connection* connection)
+{
+	MutexLock lock(m_mutex);
+	m_idle.push_back(connection);
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "Connection.h"
+#include "ConnectionOptions.h"
+
+namespace dbc
+{
+	typedef std::shared_ptr<Connection> ReadConnection;
+
+	// Pool of read-only connections to the container's database. In WAL mode the readers don't block each other
+	// and the writer, so the metadata queries of the different threads are not serialized on the primary connection.
+	// The primary connection is used instead of the pooled one if the pool is empty or disabled (capacity is 0),
+	// and if the primary connection has an opened transaction: its uncommitted changes must be visible for the reads.
+	class ReadConnectionsPool: public std::enable_shared_from_this<ReadConnectionsPool>
+	{
+		NONCOPYABLE(ReadConnectionsPool);
+
+	public:
+		// Checked out connections keep the pool alive, so it must be created as shared_ptr
+		ReadConnectionsPool(Connection& primary, const std::string& dbPath, const ConnectionOptions& options, size_t capacity);
+		~ReadConnectionsPool();
+
+		// Connection returns to the pool when the last copy of ReadConnection is destroyed
+		ReadConnection Checkout();
+		size_t Capacity() const;
+		size_t Opened(); // Idle and checked out connections
+
+	private:
+		Connection* OpenConnection();
+		void Return(Connection* connection);
+
+	private:
+		std::mutex m_mutex;
+		Connection& m_primary;
+		std::string m_dbPath;
+		ConnectionOptions m_options;
+		size_t m_capacity;
+		size_t m_opened;
+		std::vector<Connection*> m_idle;
+	};
+
+	typedef std::shared_ptr<ReadConnectionsPool> ReadConnectionsPoolGuard;
+}
@@ -6,22 +6,14 @@
 #include "Logging.h"
 
 dbc::SQLQuery::SQLQuery(Connection& conn, const std::string& query)
-	: m_db(conn.GetDB()), m_stmt(0), m_lastRowId(0)
+	: m_db(conn.GetDB()), m_statements(&conn.Statements()), m_stmt(0), m_lastRowId(0), m_changes(0)
 {
 	Prepare(query);
 }
 
 dbc::SQLQuery::~SQLQuery()
 {
-	int res = SQLITE_OK;
-	if (m_stmt)
-	{
-		res = sqlite3_finalize(m_stmt);
-	}
-
-	std::stringstream stream;
-	stream << "- SQLQuery closed; returned code - " << res << ": " << ((res != SQLITE_OK) ? sqlite3_errmsg(m_db) : "OK");
-	WriteLog(stream.str());
+	ReleaseSTMT();
 }
 
 void dbc::SQLQuery::Prepare(const std::string& query)
@@ -30,19 +22,12 @@ void dbc::SQLQuery::Prepare(const std::string& query)
 	{
 		throw ContainerException(SQL_DISCONNECTED);
 	}
-	if (m_stmt)
-	{
-		sqlite3_finalize(m_stmt);
-	}
+	ReleaseSTMT();
 	if (!query.empty())
 	{
-        int err = sqlite3_prepare_v2(m_db, query.c_str(), static_cast<int>(query.size()), &m_stmt, 0);
-
-		std::stringstream stream;
-		stream << "+ SQLQuery prepared: \"" << query << "\"; returned code - " << err << ": " << ((err != SQLITE_OK) ? sqlite3_errmsg(m_db) : "OK");
-		WriteLog(stream.str());
-
+		int err = m_statements->Checkout(query, m_stmt);
 		DecideToThrow(err);
+		m_query = query;
 	}
 }
 
@@ -64,6 +49,12 @@ void dbc::SQLQuery::BindInt64(int column, int64_t value)
 	DecideToThrow(sqlite3_bind_int64(m_stmt, column, value));
 }
 
+void dbc::SQLQuery::BindDouble(int column, double value)
+{
+	CheckSTMT();
+	DecideToThrow(sqlite3_bind_double(m_stmt, column, value));
+}
+
 void dbc::SQLQuery::BindText(int column, const std::string& value)
 {
 	CheckSTMT();
@@ -81,6 +72,7 @@ bool dbc::SQLQuery::Step()
 	CheckSTMT();
 	int err = sqlite3_step(m_stmt);
 	m_lastRowId = sqlite3_last_insert_rowid(m_db);
+	m_changes = sqlite3_changes(m_db);
 	DecideToThrow(err);
 
 	return err == SQLITE_ROW;
@@ -116,6 +108,12 @@ int64_t dbc::SQLQuery::ColumnInt64(int column)
 	return sqlite3_column_int64(m_stmt, column);
 }
 
+double dbc::SQLQuery::ColumnDouble(int column)
+{
+	CheckSTMT();
+	return sqlite3_column_double(m_stmt, column);
+}
+
 void dbc::SQLQuery::ColumnText(int column, std::string& out)
 {
 	CheckSTMT();
@@ -155,6 +153,11 @@ int64_t dbc::SQLQuery::LastRowId()
 	return m_lastRowId;
 }
 
+int dbc::SQLQuery::Changes()
+{
+	return m_changes;
+}
+
 void dbc::SQLQuery::CheckSTMT()
 {
 	if (!m_stmt)
@@ -163,6 +166,16 @@ void dbc::SQLQuery::CheckSTMT()
 	}
 }
 
+void dbc::SQLQuery::ReleaseSTMT()
+{
+	if (m_stmt)
+	{
+		m_statements->Return(m_query, m_stmt);
+		m_stmt = nullptr;
+		m_query.clear();
+	}
+}
+
 void dbc::SQLQuery::DecideToThrow(int errCode)
 {
 	if (errCode != SQLITE_OK && errCode != SQLITE_ROW && errCode != SQLITE_DONE)
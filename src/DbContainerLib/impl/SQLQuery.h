@@ -7,6 +7,7 @@ struct sqlite3_stmt;
 namespace dbc
 {
 	class Connection;
+	class StatementsCache;
 	union Error;
 
 	class SQLQuery
@@ -19,6 +20,7 @@ namespace dbc
 		void BindBool(int column, bool value);
 		void BindInt(int column, int value);
 		void BindInt64(int column, int64_t value);
+		void BindDouble(int column, double value);
 		void BindText(int column, const std::string& value);
 		void BindBlob(int column, const RawData& data);
 
@@ -28,18 +30,24 @@ namespace dbc
 		bool ColumnBool(int column);
 		int ColumnInt(int column);
 		int64_t ColumnInt64(int column);
+		double ColumnDouble(int column);
 		void ColumnText(int column, std::string& out);
 		void ColumnBlob(int column, RawData& data);
 
 		int64_t LastRowId();
+		int Changes(); // Rows changed by the last step of INSERT, UPDATE or DELETE
 
 	private:
 		void CheckSTMT();
 		void DecideToThrow(int errCode);
+		void ReleaseSTMT();
 
 	private:
 		::sqlite3* m_db;
+		StatementsCache* m_statements;
 		::sqlite3_stmt* m_stmt;
+		std::string m_query;
 		int64_t m_lastRowId;
+		int m_changes;
 	};
 }
\ No newline at end of file
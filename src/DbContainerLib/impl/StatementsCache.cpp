@@ -0,0 +1,114 @@
+#include "stdafx.h"
+#include "sqlite3.h"
+#include "StatementsCache.h"
+#include "Logging.h"
+
+dbc::StatementsCache::StatementsCache(size_t capacity)
+	: m_db(nullptr)
+	, m_capacity(capacity)
+{ }
+
+dbc::StatementsCache::~StatementsCache()
+{
+	FinalizeAll();
+}
+
+void dbc::StatementsCache::Reset(sqlite3* db)
+{
+	MutexLock lock(m_mutex);
+	FinalizeAll();
+	m_db = db;
+}
+
+int dbc::StatementsCache::Checkout(const std::string& query, sqlite3_stmt*& stmt)
+{
+	{
+		MutexLock lock(m_mutex);
+		StatementsIndex_mp::iterator found = m_index.find(query);
+		if (found != m_index.end())
+		{
+			stmt = found->second->second;
+			m_statements.erase(found->second);
+			m_index.erase(found);
+			++m_stats.hits;
+			return SQLITE_OK;
+		}
+		++m_stats.misses;
+	}
+
+	stmt = nullptr;
+	int err = sqlite3_prepare_v2(m_db, query.c_str(), static_cast<int>(query.size()), &stmt, 0);
+
+	std::stringstream stream;
+	stream << "+ SQLQuery prepared: \"" << query << "\"; returned code - " << err << ": " << ((err != SQLITE_OK) ? sqlite3_errmsg(m_db) : "OK");
+	WriteLog(stream.str());
+
+	return err;
+}
+
+void dbc::StatementsCache::Return(const std::string& query, sqlite3_stmt* stmt)
+{
+	if (stmt == nullptr)
+	{
+		return;
+	}
+
+	// sqlite3_reset() repeats the error code of the last step, it was already reported by SQLQuery
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
+
+	MutexLock lock(m_mutex);
+	// The statement was prepared for another database or the same query is already idle in the cache (it was checked out twice)
+	if (m_capacity == 0 || sqlite3_db_handle(stmt) != m_db || m_index.find(query) != m_index.end())
+	{
+		sqlite3_finalize(stmt);
+		return;
+	}
+
+	m_statements.push_front(std::make_pair(query, stmt));
+	m_index[query] = m_statements.begin();
+	TrimToCapacity();
+}
+
+void dbc::StatementsCache::SetCapacity(size_t capacity)
+{
+	MutexLock lock(m_mutex);
+	m_capacity = capacity;
+	TrimToCapacity();
+}
+
+dbc::StatementsCache::Statistics dbc::StatementsCache::GetStatistics()
+{
+	MutexLock lock(m_mutex);
+	Statistics stats(m_stats);
+	stats.size = m_statements.size();
+	stats.capacity = m_capacity;
+	return stats;
+}
+
+void dbc::StatementsCache::ResetStatistics()
+{
+	MutexLock lock(m_mutex);
+	m_stats = Statistics();
+}
+
+void dbc::StatementsCache::FinalizeAll()
+{
+	for (auto& statement : m_statements)
+	{
+		sqlite3_finalize(statement.second);
+	}
+	m_statements.clear();
+	m_index.clear();
+}
+
+void dbc::StatementsCache::TrimToCapacity()
+{
+	while (m_statements.size() > m_capacity)
+	{
+		m_index.erase(m_statements.back().first);
+		sqlite3_finalize(m_statements.back().second);
+		m_statements.pop_back();
+		++m_stats.evictions;
+	}
+}
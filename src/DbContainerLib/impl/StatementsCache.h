@@ -0,0 +1,62 @@
+#pragma once
+#include "TypesInternal.h"
+#include <list>
+#include <unordered_map>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace dbc
+{
+	// LRU cache of prepared statements keyed by SQL text. Only idle statements are stored here:
+	// SQLQuery checks a statement out for its lifetime and returns it when it is done, already reset and with bindings cleared.
+	class StatementsCache
+	{
+		NONCOPYABLE(StatementsCache);
+
+	public:
+		static const size_t DEFAULT_CAPACITY = 64;
+
+		struct Statistics
+		{
+			Statistics()
+				: hits(0), misses(0), evictions(0), size(0), capacity(0)
+			{ }
+
+			uint64_t hits;
+			uint64_t misses; // Every miss is a real sqlite3_prepare_v2 call
+			uint64_t evictions;
+			size_t size;
+			size_t capacity;
+		};
+
+		explicit StatementsCache(size_t capacity = DEFAULT_CAPACITY);
+		~StatementsCache();
+
+		// Finalizes all cached statements and starts to work with the new database handle (may be nullptr)
+		void Reset(sqlite3* db);
+
+		// Returns SQLite result code of preparing if the statement wasn't found in the cache
+		int Checkout(const std::string& query, sqlite3_stmt*& stmt);
+		void Return(const std::string& query, sqlite3_stmt* stmt);
+
+		void SetCapacity(size_t capacity); // 0 disables caching
+		Statistics GetStatistics();
+		void ResetStatistics();
+
+	private:
+		void FinalizeAll();
+		void TrimToCapacity();
+
+	private:
+		typedef std::list<std::pair<std::string, sqlite3_stmt*>> Statements_lst; // the most recently used is the first
+		typedef std::unordered_map<std::string, Statements_lst::iterator> StatementsIndex_mp;
+
+		std::mutex m_mutex;
+		sqlite3* m_db;
+		size_t m_capacity;
+		Statements_lst m_statements;
+		StatementsIndex_mp m_index;
+		Statistics m_stats;
+	};
+}
@@ -21,6 +21,18 @@ namespace dbc
 		}
 	};
 
+	struct TailInfo // The last partial cluster of the file in the shared tail block
+	{
+		TailInfo(int64_t blockId = 0, uint64_t offset = 0, uint64_t start = 0, uint64_t size = 0)
+			: blockId(blockId), offset(offset), start(start), size(size)
+		{ }
+
+		int64_t blockId;
+		uint64_t offset; // In the block
+		uint64_t start; // In the data storage
+		uint64_t size;
+	};
+
 	typedef std::vector<StreamInfo> StreamsChain_vt;
 	typedef std::set<uint64_t> StreamsIds_st;
 	typedef std::map<uint64_t, StreamsIds_st> StreamsIdsSets_mp;
@@ -1,47 +1,39 @@
 #include "stdafx.h"
 #include "SymLink.h"
+#include "ElementsIterator.h"
 #include "CommonUtils.h"
 #include "FsUtils.h"
 #include "ContainerException.h"
 #include "IContainnerResources.h"
 
+// The target was validated when it was saved
 dbc::SymLink::SymLink(ContainerResources resources, int64_t id)
     : Link(resources, id)
-	, m_target(nullptr)
-{
-    if (!m_props.Meta().empty())
-	{
-        InitTarget(m_props.Meta());
-	}
-}
+{ }
 
 dbc::SymLink::SymLink(ContainerResources resources, int64_t parentId, const std::string& name)
     : Link(resources, parentId, name)
-	, m_target(nullptr)
-{
-    if (!m_props.Meta().empty())
-	{
-        InitTarget(m_props.Meta());
-	}
-}
+{ }
+
+dbc::SymLink::SymLink(ContainerResources resources, const ElementInfo& info)
+    : Link(resources, info)
+{ }
 
 std::string dbc::SymLink::TargetPath() const
 {
-	if (m_target == nullptr)
-	{
-		return "";
-	}
-	return m_target;
+	MutexLock lock(m_rowMutex);
+	return m_linkTarget;
 }
 
 dbc::ElementGuard dbc::SymLink::Target()
 {
     Refresh();
-	if (m_target == nullptr)
+	std::string target = TargetPath();
+	if (target.empty())
 	{
 		return (ElementGuard(nullptr));
 	}
-    return m_resources->GetContainer().GetElement(m_target);
+    return m_resources->GetContainer().GetElement(target);
 }
 
 void dbc::SymLink::ChangeTarget(dbc::Element& newTarget)
@@ -83,6 +75,5 @@ void dbc::SymLink::InitTarget(const std::string& target)
 	{
 		throw ContainerException(err);
 	}
-    UpdateModifiedAndMetaData(target.c_str());
-    m_target = m_props.Meta().data();
+    UpdateLinkTarget(target);
 }
@@ -29,7 +29,8 @@ void dbc::detail::CreateNewSavepointName(std::string& name)
 }
 
 dbc::TransactionsResources::TransactionsResources(Connection* connection)
-	: m_connection(connection)
+	: m_rollbacks(0)
+	, m_connection(connection)
 { }
 
 dbc::Connection* dbc::TransactionsResources::GetConnection()
@@ -44,6 +45,16 @@ std::string dbc::TransactionsResources::NextTransactionName()
 	return m_lastTransactionName;
 }
 
+void dbc::TransactionsResources::ReportRollback()
+{
+	++m_rollbacks;
+}
+
+uint64_t dbc::TransactionsResources::Rollbacks() const
+{
+	return m_rollbacks;
+}
+
 dbc::TransactionGuardImpl::TransactionGuardImpl(TransactionsResourcesGuard resources)
 	: m_resources(resources)
 	, m_committed(false)
@@ -59,7 +70,10 @@ dbc::TransactionGuardImpl::~TransactionGuardImpl()
 	{
 		if (!m_committed)
 		{
+			m_resources->ReportRollback(); // Even if it fails, the state of the database isn't known to the caches
+			// ROLLBACK TO keeps the savepoint opened, so the outermost one would leave the transaction opened
 			TransactionQueryImpl("ROLLBACK TO SAVEPOINT " + m_transactionName + ";");
+			TransactionQueryImpl("RELEASE SAVEPOINT " + m_transactionName + ";");
 		}
 	}
 	catch(const ContainerException& ex)
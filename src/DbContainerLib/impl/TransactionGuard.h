@@ -1,5 +1,6 @@
 #pragma once
 #include "TypesInternal.h"
+#include <atomic>
 
 namespace dbc
 {
@@ -16,9 +17,12 @@ namespace dbc
 			TransactionsResources(Connection* connection);
 			Connection* GetConnection();
 			std::string NextTransactionName();
+			void ReportRollback();
+			uint64_t Rollbacks() const;
 
 		private:
 			std::string m_lastTransactionName;
+			std::atomic<uint64_t> m_rollbacks;
 			std::mutex m_changeNameMutex;
 			Connection* m_connection;
 	};
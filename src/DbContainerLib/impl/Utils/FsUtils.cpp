@@ -1,6 +1,12 @@
 #include "stdafx.h"
 #include "FsUtils.h"
 #include "ContainerAPI.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 std::string dbc::utils::SlashedPath(const std::string& in)
 {
@@ -38,6 +44,35 @@ bool dbc::utils::FileExists(const std::string& name)
 	return (stat(name.c_str(), &buffer) == 0);
 }
 
+bool dbc::utils::ExtendFile(const std::string& fname, uint64_t size)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA(fname.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER end;
+	bool extended = GetFileSizeEx(file, &end) != FALSE;
+	if (extended && end.QuadPart < static_cast<LONGLONG>(size)) // SetEndOfFile() would truncate the larger file
+	{
+		end.QuadPart = static_cast<LONGLONG>(size);
+		extended = SetFilePointerEx(file, end, NULL, FILE_BEGIN) && SetEndOfFile(file);
+	}
+	CloseHandle(file);
+	return extended;
+#else
+	int file = open(fname.c_str(), O_WRONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+	bool extended = posix_fallocate(file, 0, static_cast<off_t>(size)) == 0; // Doesn't shrink the file
+	close(file);
+	return extended;
+#endif
+}
+
 uint64_t dbc::utils::TellMaxAvailable(std::istream &in, uint64_t required_size)
 {
 	std::ios::pos_type origin;
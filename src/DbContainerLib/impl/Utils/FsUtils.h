@@ -10,6 +10,9 @@ namespace dbc
 		bool FileNameIsValid(const std::string& fname);
 
 		bool FileExists(const std::string& fname);
+		// Grows the file to the size without writing its content: posix_fallocate() reserves the blocks,
+		// SetEndOfFile() moves the end of file on Windows. Returns false if the file system can't do it.
+		bool ExtendFile(const std::string& fname, uint64_t size);
 
 		uint64_t TellMaxAvailable(std::istream& in, uint64_t requiredSize);
 
@@ -0,0 +1,71 @@
+#include "stdafx.h"
+#include "WorkloadTuner.h"
+
+dbc::WorkloadTuner::WorkloadTuner()
+	: m_streams(0)
+{
+	m_sizes.reserve(SAMPLES_PER_DECISION);
+}
+
+bool dbc::WorkloadTuner::RecordWrite(uint64_t size, uint64_t streams, const DataUsagePreferences& prefs, TuningDecision& decision)
+{
+	m_sizes.push_back(size);
+	m_streams += streams;
+	if (m_sizes.size() < SAMPLES_PER_DECISION)
+	{
+		return false;
+	}
+
+	Decide(prefs, decision);
+	Reset();
+	return true;
+}
+
+void dbc::WorkloadTuner::Reset()
+{
+	m_sizes.clear();
+	m_streams = 0;
+}
+
+void dbc::WorkloadTuner::Decide(const DataUsagePreferences& prefs, TuningDecision& decision) const
+{
+	std::vector<uint64_t> sizes(m_sizes);
+	std::vector<uint64_t>::iterator median = sizes.begin() + sizes.size() / 2;
+	std::nth_element(sizes.begin(), median, sizes.end());
+
+	decision.time = static_cast<int64_t>(::time(nullptr));
+	decision.samples = m_sizes.size();
+	decision.medianWriteSize = *median;
+	decision.averageStreams = static_cast<double>(m_streams) / m_sizes.size();
+	decision.oldClusterSizeLevel = prefs.ClusterSizeLevel();
+	decision.oldTailPacking = prefs.TailPacking();
+
+	std::stringstream reason;
+	unsigned short level = DataUsagePreferences::CLUSTER_SIZE_MIN;
+	while (level < DataUsagePreferences::CLUSTER_SIZE_MAX && DataUsagePreferences::GetRealClusterSize(level + 1) * static_cast<uint64_t>(4) <= decision.medianWriteSize)
+	{
+		++level;
+	}
+	reason << "median write is " << decision.medianWriteSize << " bytes";
+	if (decision.averageStreams > MAX_AVERAGE_STREAMS && level < DataUsagePreferences::CLUSTER_SIZE_MAX)
+	{
+		++level;
+		reason << ", the written files have " << decision.averageStreams << " streams on average";
+	}
+	decision.newClusterSizeLevel = level;
+
+	DataUsagePreferences tuned(prefs);
+	tuned.SetClusterSizeLevel(level);
+	uint64_t written = 0;
+	uint64_t wasted = 0;
+	for (uint64_t size : m_sizes)
+	{
+		uint64_t clusterSize = tuned.ClusterSizeFor(size);
+		written += size;
+		wasted += (clusterSize - size % clusterSize) % clusterSize;
+	}
+	decision.wasteRatio = written > 0 ? static_cast<double>(wasted) / written : 0;
+	decision.newTailPacking = decision.wasteRatio > 0.25 || (prefs.TailPacking() && decision.wasteRatio >= 0.05);
+	reason << ", the last partial clusters waste " << static_cast<int>(decision.wasteRatio * 100) << "% of the written data";
+	decision.reason = reason.str();
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "TypesInternal.h"
+#include "DataUsagePreferences.h"
+#include "TuningDecision.h"
+
+namespace dbc
+{
+	// Samples the sizes of the writes and the used streams of the written files for DataUsagePreferences::AutoTune().
+	// Every SAMPLES_PER_DECISION writes it chooses the cluster size level and the tail packing for the sampled workload:
+	// the cluster is up to 1/4 of the median write and one level larger if the files are spread over many streams.
+	// The tail packing is enabled if the last partial clusters waste more than 1/4 of the written data and disabled below 1/20.
+	class WorkloadTuner
+	{
+		NONCOPYABLE(WorkloadTuner);
+
+	public:
+		static const size_t SAMPLES_PER_DECISION = 256;
+		static const unsigned int MAX_AVERAGE_STREAMS = 4;
+
+		WorkloadTuner();
+
+		// Returns true if the decision is made on this sample. The samples are cleared then.
+		bool RecordWrite(uint64_t size, uint64_t streams, const DataUsagePreferences& prefs, TuningDecision& decision);
+		void Reset();
+
+	private:
+		void Decide(const DataUsagePreferences& prefs, TuningDecision& decision) const;
+
+	private:
+		std::vector<uint64_t> m_sizes;
+		uint64_t m_streams;
+	};
+}
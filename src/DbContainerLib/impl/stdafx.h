@@ -17,6 +17,7 @@
 #include <sys/stat.h>
 #include <mutex>
 #include <atomic>
+#include <thread>
 
 #include <openssl/aes.h>
 #include <openssl/evp.h>
@@ -33,6 +33,31 @@ SOURCES += \
     TestI.cpp \
     TestJ.cpp \
     TestK.cpp \
+    TestL.cpp \
+    TestM.cpp \
+    TestN.cpp \
+    TestO.cpp \
+    TestP.cpp \
+    TestQ.cpp \
+    TestR.cpp \
+    TestS.cpp \
+    TestT.cpp \
+    TestU.cpp \
+    TestV.cpp \
+    TestW.cpp \
+    TestX.cpp \
+    TestY.cpp \
+    TestZ.cpp \
+    TestZA.cpp \
+    TestZB.cpp \
+    TestZC.cpp \
+    TestZD.cpp \
+    TestZE.cpp \
+    TestZF.cpp \
+    TestZG.cpp \
+    TestZH.cpp \
+    TestZI.cpp \
+    TestZJ.cpp \
     Utils.cpp
 
 
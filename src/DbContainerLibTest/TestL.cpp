@@ -0,0 +1,107 @@
+#include "stdafx.h"
+#include "ContainerAPI.h"
+#include "ContainerException.h"
+#include "impl/Connection.h"
+#include "impl/Utils/FsUtils.h"
+
+using namespace dbc;
+
+namespace
+{
+	const std::string s_connectionDbPath = "connection_test.db";
+
+	void RemoveConnectionDb()
+	{
+		remove(s_connectionDbPath.c_str());
+	}
+}
+
+TEST(L_StatementsCacheTest, HitsAndMisses)
+{
+	RemoveConnectionDb();
+	Connection connection(s_connectionDbPath, true);
+	connection.ExecQuery("CREATE TABLE Test(id INTEGER PRIMARY KEY NOT NULL, value INTEGER);");
+	StatementsCache& statements = connection.Statements();
+	statements.ResetStatistics();
+
+	const std::string insertQuery("INSERT INTO Test(value) VALUES (?);");
+	for (int i = 0; i < 10; ++i)
+	{
+		SQLQuery query(connection, insertQuery);
+		query.BindInt(1, i);
+		query.Step();
+	}
+
+	StatementsCache::Statistics stats = statements.GetStatistics();
+	EXPECT_EQ(1, stats.misses);
+	EXPECT_EQ(9, stats.hits);
+	EXPECT_EQ(1, stats.size);
+
+	// Statements are returned to the cache without bindings
+	SQLQuery query(connection, "SELECT count(*) FROM Test WHERE value IS NULL;");
+	ASSERT_TRUE(query.Step());
+	EXPECT_EQ(0, query.ColumnInt(0));
+	{
+		SQLQuery insert(connection, insertQuery);
+		insert.Step();
+	}
+	query.Reset();
+	ASSERT_TRUE(query.Step());
+	EXPECT_EQ(1, query.ColumnInt(0));
+	RemoveConnectionDb();
+}
+
+TEST(L_StatementsCacheTest, SameQueryCheckedOutTwice)
+{
+	RemoveConnectionDb();
+	Connection connection(s_connectionDbPath, true);
+	connection.ExecQuery("CREATE TABLE Test(id INTEGER PRIMARY KEY NOT NULL, value INTEGER);");
+	connection.ExecQuery("INSERT INTO Test(value) VALUES (1);");
+	connection.ExecQuery("INSERT INTO Test(value) VALUES (2);");
+	StatementsCache& statements = connection.Statements();
+	statements.ResetStatistics();
+
+	const std::string selectQuery("SELECT value FROM Test ORDER BY value;");
+	{
+		SQLQuery outer(connection, selectQuery);
+		ASSERT_TRUE(outer.Step());
+		EXPECT_EQ(1, outer.ColumnInt(0));
+		{
+			SQLQuery inner(connection, selectQuery); // Must not share the statement with the outer query
+			ASSERT_TRUE(inner.Step());
+			EXPECT_EQ(1, inner.ColumnInt(0));
+		}
+		ASSERT_TRUE(outer.Step());
+		EXPECT_EQ(2, outer.ColumnInt(0));
+	}
+
+	StatementsCache::Statistics stats = statements.GetStatistics();
+	EXPECT_EQ(2, stats.misses);
+	EXPECT_EQ(1, stats.size);
+	RemoveConnectionDb();
+}
+
+TEST(L_StatementsCacheTest, Capacity)
+{
+	RemoveConnectionDb();
+	Connection connection(s_connectionDbPath, true);
+	StatementsCache& statements = connection.Statements();
+	statements.SetCapacity(2);
+	statements.ResetStatistics();
+
+	const char* queries[] = { "SELECT 1;", "SELECT 2;", "SELECT 3;", "SELECT 1;" };
+	for (const char* queryStr : queries)
+	{
+		SQLQuery query(connection, queryStr);
+		query.Step();
+	}
+
+	StatementsCache::Statistics stats = statements.GetStatistics();
+	EXPECT_EQ(4, stats.misses); // "SELECT 1;" was evicted by "SELECT 3;"
+	EXPECT_EQ(2, stats.evictions);
+	EXPECT_EQ(2, stats.size);
+
+	statements.SetCapacity(0);
+	EXPECT_EQ(0, statements.GetStatistics().size);
+	RemoveConnectionDb();
+}
@@ -0,0 +1,99 @@
+#include "stdafx.h"
+#include "ContainerAPI.h"
+#include "ContainerException.h"
+#include "impl/Connection.h"
+#include "Utils.h"
+
+using namespace dbc;
+
+extern std::string db_path;
+extern std::string pass;
+
+extern ContainerGuard cont;
+
+namespace
+{
+	// Turns the freshly created container into the container of the first version: without indexes, closure table and schema version
+	void DowngradeToInitialSchema()
+	{
+		Connection connection(db_path, false);
+		connection.ExecQuery("DROP INDEX idx_FileSystem_parent_name;");
+		connection.ExecQuery("DROP INDEX idx_FileStreams_file_order;");
+		connection.ExecQuery("DROP INDEX idx_FileStreams_used_size;");
+		connection.ExecQuery("DROP INDEX idx_FileSystem_parent_type;");
+		connection.ExecQuery("DROP INDEX idx_FileSystem_parent_modified;");
+		connection.ExecQuery("DROP INDEX idx_FileSystem_parent_created;");
+		connection.ExecQuery("DROP TRIGGER trg_FileSystem_insert;");
+		connection.ExecQuery("DROP TRIGGER trg_FileSystem_delete;");
+		connection.ExecQuery("DROP TRIGGER trg_FileSystem_move;");
+		connection.ExecQuery("DROP TRIGGER trg_FileStreams_insert;");
+		connection.ExecQuery("DROP TRIGGER trg_FileStreams_delete;");
+		connection.ExecQuery("DROP TRIGGER trg_FileStreams_update;");
+		connection.ExecQuery("DROP TRIGGER trg_FileSystem_delete_meta;");
+		connection.ExecQuery("DROP TABLE FileSystemTree;");
+		connection.ExecQuery("DROP TABLE FolderAggregates;");
+		connection.ExecQuery("DROP TABLE ElementsMeta;");
+		connection.ExecQuery("DROP TABLE Sets;");
+		connection.ExecQuery("CREATE TABLE Sets(id INTEGER PRIMARY KEY NOT NULL, storage_data_size INTEGER, storage_data BLOB);");
+	}
+
+	int CountIndexes(Connection& connection)
+	{
+		SQLQuery query(connection, "SELECT count(*) FROM sqlite_master WHERE type = 'index' AND name IN ('idx_FileSystem_parent_name', 'idx_FileStreams_file_order', 'idx_FileStreams_used_size', "
+			"'idx_FileSystem_parent_type', 'idx_FileSystem_parent_modified', 'idx_FileSystem_parent_created');");
+		query.Step();
+		return query.ColumnInt(0);
+	}
+}
+
+TEST(M_SchemaTest, NewContainerIsIndexed)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	DatabaseDisconnect();
+
+	Connection connection(db_path, false);
+	EXPECT_EQ(6, CountIndexes(connection));
+	SQLQuery query(connection, "SELECT schema_version FROM Sets WHERE id = 1;");
+	ASSERT_TRUE(query.Step());
+	EXPECT_GT(query.ColumnInt(0), 0);
+}
+
+TEST(M_SchemaTest, UpgradeOnConnect)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+	root->CreateFolder("folder")->CreateFile("file");
+	DatabaseDisconnect();
+
+	DowngradeToInitialSchema();
+	{
+		Connection connection(db_path, false);
+		EXPECT_EQ(0, CountIndexes(connection));
+	}
+
+	ASSERT_NO_THROW(cont = Connect(db_path, pass));
+	EXPECT_NE(nullptr, cont->GetElement("/folder/file").get());
+	cont.reset();
+
+	Connection connection(db_path, false);
+	EXPECT_EQ(6, CountIndexes(connection));
+	SQLQuery query(connection, "SELECT schema_version FROM Sets WHERE id = 1;");
+	ASSERT_TRUE(query.Step());
+	EXPECT_GT(query.ColumnInt(0), 0);
+}
+
+TEST(M_SchemaTest, UpgradeOfDamagedContainer)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	cont->GetRoot()->CreateFile("file");
+	DatabaseDisconnect();
+
+	DowngradeToInitialSchema();
+	{
+		Connection connection(db_path, false);
+		connection.ExecQuery("INSERT INTO FileSystem(parent_id, name, type, created, modified) SELECT parent_id, name, type, created, modified FROM FileSystem WHERE name = 'file';");
+	}
+
+	EXPECT_THROW(cont = Connect(db_path, pass), ContainerException);
+	DatabaseRemove();
+}
@@ -0,0 +1,145 @@
+#include "stdafx.h"
+#include "ContainerAPI.h"
+#include "ContainerException.h"
+#include "impl/Connection.h"
+#include "Utils.h"
+#include <chrono>
+
+using namespace dbc;
+
+extern std::string db_path;
+extern std::string pass;
+
+extern ContainerGuard cont;
+
+namespace
+{
+	std::string QueryPragma(Connection& connection, const std::string& pragma)
+	{
+		SQLQuery query(connection, "PRAGMA " + pragma + ";");
+		query.Step();
+		std::string value;
+		query.ColumnText(0, value);
+		return value;
+	}
+
+	ContainerGuard RecreateContainer(const ConnectionOptions& options)
+	{
+		DatabaseRemove();
+		return CreateContainer(db_path, pass, options);
+	}
+}
+
+TEST(N_ConnectionOptionsTest, Profiles)
+{
+	ConnectionOptions compatible(TuningProfileCompatible);
+	EXPECT_EQ(DbJournalModeDelete, compatible.JournalMode());
+	EXPECT_EQ(DbSynchronousFull, compatible.Synchronous());
+	EXPECT_TRUE(compatible.IncrementalVacuum());
+
+	ConnectionOptions balanced(TuningProfileBalanced);
+	EXPECT_EQ(DbJournalModeWal, balanced.JournalMode());
+	EXPECT_EQ(DbSynchronousNormal, balanced.Synchronous());
+	EXPECT_GT(balanced.CacheSizeKb(), compatible.CacheSizeKb());
+	EXPECT_GT(balanced.MmapSize(), compatible.MmapSize());
+}
+
+TEST(N_ConnectionOptionsTest, PragmasApplied)
+{
+	ConnectionOptions options(TuningProfileBalanced);
+	options.SetCacheSizeKb(4096);
+	ContainerGuard container = RecreateContainer(options);
+	EXPECT_EQ(DbJournalModeWal, container->GetConnectionOptions().JournalMode());
+	container.reset();
+
+	Connection connection(db_path, false);
+	EXPECT_EQ("wal", QueryPragma(connection, "journal_mode"));
+	EXPECT_EQ("2", QueryPragma(connection, "auto_vacuum")); // INCREMENTAL
+	connection.Disconnect();
+
+	container = Connect(db_path, pass, ConnectionOptions(TuningProfileCompatible));
+	container.reset();
+	Connection connection2(db_path, false);
+	EXPECT_EQ("delete", QueryPragma(connection2, "journal_mode"));
+	connection2.Disconnect();
+	DatabaseRemove();
+}
+
+TEST(N_ConnectionOptionsTest, IdleVacuum)
+{
+	ConnectionOptions options;
+	options.SetVacuumStepPages(1);
+	ContainerGuard container = RecreateContainer(options);
+	EXPECT_FALSE(container->IdleVacuum()); // Nothing to release
+
+	FolderGuard root = container->GetRoot();
+	const std::string bigMeta(10000, 'm');
+	for (int i = 0; i < 20; ++i)
+	{
+		root->CreateFolder("folder " + std::to_string(i), bigMeta);
+	}
+	DbcElementsIterator it = root->EnumFsEntries();
+	while (it->HasNext())
+	{
+		it->Next()->Remove();
+	}
+
+	EXPECT_TRUE(container->IdleVacuum()); // Only one page was released
+	int steps = 1;
+	while (container->IdleVacuum())
+	{
+		++steps;
+	}
+	EXPECT_GT(steps, 1);
+	container.reset();
+	DatabaseRemove();
+}
+
+// Not a test: prints the time of metadata-heavy workload under each tuning profile. Run with --gtest_also_run_disabled_tests
+TEST(N_ConnectionOptionsTest, DISABLED_Benchmark_MetadataWorkload)
+{
+	const int foldersCount = 20;
+	const int filesCount = 100;
+	const char* profileNames[] = { "Compatible", "Balanced", "Throughput" };
+	const TuningProfile profiles[] = { TuningProfileCompatible, TuningProfileBalanced, TuningProfileThroughput };
+	for (size_t profile = 0; profile < sizeof(profiles) / sizeof(profiles[0]); ++profile)
+	{
+		ContainerGuard container = RecreateContainer(ConnectionOptions(profiles[profile]));
+		auto start = std::chrono::steady_clock::now();
+
+		FolderGuard root = container->GetRoot();
+		for (int i = 0; i < foldersCount; ++i)
+		{
+			FolderGuard folder = root->CreateFolder("folder " + std::to_string(i));
+			for (int j = 0; j < filesCount; ++j)
+			{
+				folder->CreateFile("file " + std::to_string(j));
+			}
+		}
+		auto created = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < foldersCount; ++i)
+		{
+			for (int j = 0; j < filesCount; j += 10)
+			{
+				container->GetElement("/folder " + std::to_string(i) + "/file " + std::to_string(j))->Path();
+			}
+			DbcElementsIterator it = root->GetChild("folder " + std::to_string(i))->AsFolder()->EnumFsEntries();
+			while (it->HasNext())
+			{
+				it->Next()->GetProperties();
+			}
+		}
+		auto listed = std::chrono::steady_clock::now();
+
+		root->GetChild("folder 0")->Remove();
+		while (container->IdleVacuum());
+		auto removed = std::chrono::steady_clock::now();
+
+		typedef std::chrono::milliseconds ms;
+		std::cout << profileNames[profile] << ": create " << std::chrono::duration_cast<ms>(created - start).count()
+			<< " ms, lookup and list " << std::chrono::duration_cast<ms>(listed - created).count()
+			<< " ms, remove and vacuum " << std::chrono::duration_cast<ms>(removed - listed).count() << " ms" << std::endl;
+	}
+	DatabaseRemove();
+}
@@ -0,0 +1,218 @@
+#include "stdafx.h"
+#include "ContainerAPI.h"
+#include "ContainerException.h"
+#include "impl/ReadConnectionsPool.h"
+#include "Utils.h"
+#include <chrono>
+#include <thread>
+
+using namespace dbc;
+
+extern std::string db_path;
+extern std::string pass;
+
+namespace
+{
+	const std::string s_poolDbPath = "pool_test.db";
+
+	void RemovePoolDb()
+	{
+		remove(s_poolDbPath.c_str());
+		remove((s_poolDbPath + "-wal").c_str());
+		remove((s_poolDbPath + "-shm").c_str());
+	}
+
+	void PreparePoolDb(Connection& primary)
+	{
+		primary.ExecQuery("PRAGMA journal_mode = WAL;");
+		primary.ExecQuery("CREATE TABLE Test(id INTEGER PRIMARY KEY NOT NULL, value INTEGER);");
+		primary.ExecQuery("INSERT INTO Test(value) VALUES (1);");
+	}
+
+	int CountRows(Connection& connection)
+	{
+		SQLQuery query(connection, "SELECT count(*) FROM Test;");
+		query.Step();
+		return query.ColumnInt(0);
+	}
+
+	// Creates folders "/folder i" with the files "file j" inside
+	void FillContainer(ContainerGuard container, int foldersCount, int filesCount)
+	{
+		FolderGuard root = container->GetRoot();
+		for (int i = 0; i < foldersCount; ++i)
+		{
+			FolderGuard folder = root->CreateFolder("folder " + std::to_string(i));
+			for (int j = 0; j < filesCount; ++j)
+			{
+				folder->CreateFile("file " + std::to_string(j));
+			}
+		}
+	}
+
+	// Resolves the paths of all files and reads their properties, returns the number of resolved files
+	int ReadContainer(ContainerGuard container, int foldersCount, int filesCount)
+	{
+		int resolved = 0;
+		for (int i = 0; i < foldersCount; ++i)
+		{
+			for (int j = 0; j < filesCount; ++j)
+			{
+				ElementGuard element = container->GetElement("/folder " + std::to_string(i) + "/file " + std::to_string(j));
+				if (element && element->Path() == "/folder " + std::to_string(i) + "/file " + std::to_string(j))
+				{
+					element->GetProperties();
+					++resolved;
+				}
+			}
+		}
+		return resolved;
+	}
+}
+
+TEST(O_ReadConnectionsPoolTest, CheckoutAndReturn)
+{
+	RemovePoolDb();
+	Connection primary(s_poolDbPath, true);
+	PreparePoolDb(primary);
+	ReadConnectionsPoolGuard pool = std::make_shared<ReadConnectionsPool>(primary, s_poolDbPath, ConnectionOptions(), 2);
+
+	ReadConnection first = pool->Checkout();
+	ReadConnection second = pool->Checkout();
+	EXPECT_NE(&primary, first.get());
+	EXPECT_NE(&primary, second.get());
+	EXPECT_NE(first.get(), second.get());
+	EXPECT_EQ(&primary, pool->Checkout().get()); // The pool is exhausted
+	EXPECT_EQ(1, CountRows(*first));
+
+	Connection* firstPtr = first.get();
+	first.reset();
+	EXPECT_EQ(firstPtr, pool->Checkout().get());
+	EXPECT_EQ(2, pool->Opened());
+
+	// Read connections are read-only
+	EXPECT_THROW(second->ExecQuery("INSERT INTO Test(value) VALUES (2);"), ContainerException);
+
+	second.reset();
+	pool.reset();
+	primary.Disconnect();
+	RemovePoolDb();
+}
+
+TEST(O_ReadConnectionsPoolTest, PrimaryIsUsedInTransaction)
+{
+	RemovePoolDb();
+	Connection primary(s_poolDbPath, true);
+	PreparePoolDb(primary);
+	ReadConnectionsPoolGuard pool = std::make_shared<ReadConnectionsPool>(primary, s_poolDbPath, ConnectionOptions(), 2);
+	{
+		TransactionGuard transaction = primary.StartTransaction();
+		primary.ExecQuery("INSERT INTO Test(value) VALUES (2);");
+		ReadConnection connection = pool->Checkout();
+		EXPECT_EQ(&primary, connection.get());
+		EXPECT_EQ(2, CountRows(*connection)); // Uncommitted changes are visible
+		transaction->Commit();
+	}
+
+	// Committed changes are visible for the read connections
+	ReadConnection connection = pool->Checkout();
+	EXPECT_NE(&primary, connection.get());
+	EXPECT_EQ(2, CountRows(*connection));
+
+	connection.reset();
+	pool.reset();
+	primary.Disconnect();
+	RemovePoolDb();
+}
+
+TEST(O_ReadConnectionsPoolTest, DisabledPool)
+{
+	RemovePoolDb();
+	Connection primary(s_poolDbPath, true);
+	PreparePoolDb(primary);
+	ReadConnectionsPoolGuard pool = std::make_shared<ReadConnectionsPool>(primary, s_poolDbPath, ConnectionOptions(), 0);
+	EXPECT_EQ(&primary, pool->Checkout().get());
+	EXPECT_EQ(0, pool->Opened());
+
+	pool.reset();
+	primary.Disconnect();
+	RemovePoolDb();
+}
+
+TEST(O_ReadConnectionsPoolTest, ConcurrentReaders)
+{
+	const int foldersCount = 5;
+	const int filesCount = 20;
+	const int threadsCount = 4;
+
+	DatabaseRemove();
+	ContainerGuard container = CreateContainer(db_path, pass, ConnectionOptions(TuningProfileBalanced));
+	FillContainer(container, foldersCount, filesCount);
+
+	std::vector<int> resolved(threadsCount, 0);
+	std::vector<std::thread> readers;
+	for (int i = 0; i < threadsCount; ++i)
+	{
+		readers.push_back(std::thread([&, i]()
+		{
+			try
+			{
+				resolved[i] = ReadContainer(container, foldersCount, filesCount);
+			}
+			catch (const ContainerException& ex)
+			{
+				std::cout << ex.FullMessage() << std::endl;
+			}
+		}));
+	}
+	// Writer is not blocked by the readers
+	container->GetRoot()->CreateFolder("written while reading");
+	for (std::thread& reader : readers)
+	{
+		reader.join();
+	}
+
+	for (int count : resolved)
+	{
+		EXPECT_EQ(foldersCount * filesCount, count);
+	}
+	EXPECT_TRUE(container->GetElement("/written while reading"));
+	container.reset();
+	DatabaseRemove();
+}
+
+// Not a test: prints the read throughput against the number of threads. Run with --gtest_also_run_disabled_tests
+TEST(O_ReadConnectionsPoolTest, DISABLED_Benchmark_ReadThroughput)
+{
+	const int foldersCount = 10;
+	const int filesCount = 50;
+	const char* profileNames[] = { "Compatible (single connection)", "Balanced (read connections pool)" };
+	const TuningProfile profiles[] = { TuningProfileCompatible, TuningProfileBalanced };
+	const unsigned int maxThreads = std::max(4u, std::thread::hardware_concurrency());
+
+	for (size_t profile = 0; profile < sizeof(profiles) / sizeof(profiles[0]); ++profile)
+	{
+		DatabaseRemove();
+		ContainerGuard container = CreateContainer(db_path, pass, ConnectionOptions(profiles[profile]));
+		FillContainer(container, foldersCount, filesCount);
+
+		std::cout << profileNames[profile] << ":" << std::endl;
+		for (unsigned int threadsCount = 1; threadsCount <= maxThreads; threadsCount *= 2)
+		{
+			auto start = std::chrono::steady_clock::now();
+			std::vector<std::thread> readers;
+			for (unsigned int i = 0; i < threadsCount; ++i)
+			{
+				readers.push_back(std::thread([&]() { ReadContainer(container, foldersCount, filesCount); }));
+			}
+			for (std::thread& reader : readers)
+			{
+				reader.join();
+			}
+			auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+			uint64_t lookups = static_cast<uint64_t>(threadsCount) * foldersCount * filesCount;
+			std::cout << "  threads " << threadsCount << ": " << lookups * 1000 / std::max<int64_t>(elapsed, 1) << " lookups/s" << std::endl;
+		}
+	}
+	DatabaseRemove();
+}
@@ -0,0 +1,111 @@
+#include "stdafx.h"
+#include "ContainerAPI.h"
+#include "ContainerException.h"
+#include "Utils.h"
+#include <chrono>
+
+using namespace dbc;
+
+extern ContainerGuard cont;
+
+TEST(P_BulkCreationTest, CreateChildren)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+
+	ChildSpecs_vt children;
+	children.push_back(ChildSpec("folder", ElementTypeFolder, "folder meta"));
+	children.push_back(ChildSpec("file", ElementTypeFile));
+	children.push_back(ChildSpec("link", ElementTypeSymLink, "/folder"));
+
+	ElementGuards_vt elements = root->CreateChildren(children);
+	ASSERT_EQ(children.size(), elements.size());
+	for (size_t i = 0; i < children.size(); ++i)
+	{
+		EXPECT_EQ(children[i].type, elements[i]->Type());
+		EXPECT_EQ(children[i].name, elements[i]->Name());
+		EXPECT_TRUE(root->GetChild(children[i].name)->IsTheSame(*elements[i]));
+	}
+	EXPECT_EQ("folder meta", elements[0]->GetProperties().Meta());
+	EXPECT_TRUE(elements[2]->AsSymLink()->Target()->IsTheSame(*elements[0]));
+	EXPECT_TRUE(root->CreateChildren(ChildSpecs_vt()).empty());
+}
+
+TEST(P_BulkCreationTest, AllOrNothing)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+	root->CreateFile("existing");
+
+	ChildSpecs_vt children;
+	children.push_back(ChildSpec("new", ElementTypeFile));
+	children.push_back(ChildSpec("existing", ElementTypeFolder));
+	EXPECT_THROW(root->CreateChildren(children), ContainerException);
+
+	children.back().name = "new";
+	EXPECT_THROW(root->CreateChildren(children), ContainerException); // Duplicate inside the request
+
+	children.back().name = "wrong/name";
+	EXPECT_THROW(root->CreateChildren(children), ContainerException);
+
+	children.back() = ChildSpec("link", ElementTypeSymLink, "relative/path");
+	EXPECT_THROW(root->CreateChildren(children), ContainerException);
+
+	children.back() = ChildSpec("link", ElementTypeDirectLink, "1");
+	EXPECT_THROW(root->CreateChildren(children), ContainerException);
+
+	EXPECT_FALSE(root->GetChild("new"));
+	EXPECT_EQ(2, cont->GetInfo()->TotalElements()); // The root and "existing"
+}
+
+TEST(P_BulkCreationTest, ContainerCreateElements)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	cont->GetRoot()->CreateFolder("folder")->CreateFile("file");
+
+	// More names than the single check of the existing names can handle
+	ChildSpecs_vt children;
+	for (int i = 0; i < 1200; ++i)
+	{
+		children.push_back(ChildSpec("child " + std::to_string(i), i % 2 ? ElementTypeFile : ElementTypeFolder));
+	}
+	ElementGuards_vt elements = cont->CreateElements("/folder", children);
+	EXPECT_EQ(children.size(), elements.size());
+	EXPECT_EQ("/folder/child 1199", elements.back()->Path());
+	EXPECT_EQ(1203, cont->GetInfo()->TotalElements());
+
+	children.back().name = "file";
+	EXPECT_THROW(cont->CreateElements("/folder", children), ContainerException);
+	EXPECT_THROW(cont->CreateElements("/folder/file", children), ContainerException);
+	EXPECT_THROW(cont->CreateElements("/missing", children), ContainerException);
+	EXPECT_EQ(1203, cont->GetInfo()->TotalElements());
+}
+
+// Not a test: compares creation of the files one by one with the bulk creation. Run with --gtest_also_run_disabled_tests
+TEST(P_BulkCreationTest, DISABLED_Benchmark_CreateFiles)
+{
+	const int filesCount = 2000;
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+	FolderGuard single = root->CreateFolder("single");
+	FolderGuard bulk = root->CreateFolder("bulk");
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < filesCount; ++i)
+	{
+		single->CreateFile("file " + std::to_string(i));
+	}
+	auto created = std::chrono::steady_clock::now();
+
+	ChildSpecs_vt children;
+	for (int i = 0; i < filesCount; ++i)
+	{
+		children.push_back(ChildSpec("file " + std::to_string(i), ElementTypeFile));
+	}
+	bulk->CreateChildren(children);
+	auto bulkCreated = std::chrono::steady_clock::now();
+
+	typedef std::chrono::milliseconds ms;
+	std::cout << filesCount << " files one by one: " << std::chrono::duration_cast<ms>(created - start).count()
+		<< " ms, in bulk: " << std::chrono::duration_cast<ms>(bulkCreated - created).count() << " ms" << std::endl;
+}
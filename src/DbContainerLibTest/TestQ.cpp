@@ -0,0 +1,107 @@
+#include "stdafx.h"
+#include "ContainerAPI.h"
+#include "ContainerException.h"
+#include "Utils.h"
+#include <chrono>
+
+using namespace dbc;
+
+extern ContainerGuard cont;
+
+namespace
+{
+	class ProgressRecorder: public IProgressObserver
+	{
+	public:
+		virtual ProgressState OnProgressUpdated(float progress)
+		{
+			progressUpdates.push_back(progress);
+			return Continue;
+		}
+		virtual ProgressState OnInfo(const std::string& info) { return Continue; }
+		virtual ProgressState OnWarning(Error errCode) { return Continue; }
+		virtual ProgressState OnError(Error errCode) { return Stop; }
+
+		std::vector<float> progressUpdates;
+	};
+
+	// Creates the chain of nested folders with the files on every level, returns the number of created elements
+	int CreateTree(FolderGuard folder, int depth, int filesPerLevel)
+	{
+		int created = 0;
+		for (int level = 0; level < depth; ++level)
+		{
+			ChildSpecs_vt children;
+			for (int i = 0; i < filesPerLevel; ++i)
+			{
+				children.push_back(ChildSpec("file " + std::to_string(i), ElementTypeFile));
+			}
+			folder->CreateChildren(children);
+			folder = folder->CreateFolder("level " + std::to_string(level + 1));
+			created += filesPerLevel + 1;
+		}
+		return created;
+	}
+}
+
+TEST(Q_FolderRemoveTest, RemoveSubtree)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+	FolderGuard tree = root->CreateFolder("tree");
+	FolderGuard sibling = root->CreateFolder("sibling");
+	sibling->CreateFile("file");
+	int created = CreateTree(tree, 50, 3);
+	ContainerInfo info = cont->GetInfo();
+	EXPECT_EQ(created + 4, info->TotalElements());
+
+	ProgressRecorder progress;
+	tree->Remove(&progress);
+	EXPECT_FALSE(tree->Exists());
+	EXPECT_FALSE(cont->GetElement("/tree/level 1/file 0"));
+	EXPECT_TRUE(cont->GetElement("/sibling/file"));
+	EXPECT_EQ(3, info->TotalElements());
+	ASSERT_FALSE(progress.progressUpdates.empty());
+	EXPECT_FLOAT_EQ(1.0f, progress.progressUpdates.back());
+
+	EXPECT_THROW(root->Remove(), ContainerException);
+	EXPECT_NO_THROW(tree->Remove()); // Already removed
+}
+
+TEST(Q_FolderRemoveTest, StreamsAreFreed)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard folder = cont->GetRoot()->CreateFolder("folder");
+	FolderGuard nested = folder->CreateFolder("nested");
+	const std::string data("0123456789");
+	FileGuard files[] = { folder->CreateFile("file"), nested->CreateFile("file") };
+	for (FileGuard& file : files)
+	{
+		std::stringstream strm;
+		strm << data;
+		file->Write(strm, data.size());
+	}
+	ContainerInfo info = cont->GetInfo();
+	EXPECT_EQ(2 * data.size(), info->UsedSpace());
+
+	folder->Remove();
+	EXPECT_EQ(0, info->UsedSpace());
+	EXPECT_NE(0, info->TotalStreams()); // The streams are kept for the next writes
+}
+
+// Not a test: prints the time of the removal of the large tree. Run with --gtest_also_run_disabled_tests
+TEST(Q_FolderRemoveTest, DISABLED_Benchmark_RemoveLargeTree)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard tree = cont->GetRoot()->CreateFolder("tree");
+	int created = 0;
+	for (int i = 0; i < 100; ++i)
+	{
+		created += CreateTree(tree->CreateFolder("branch " + std::to_string(i)), 10, 100) + 1;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	tree->Remove();
+	auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "Removal of " << created << " elements: " << elapsed << " ms" << std::endl;
+}
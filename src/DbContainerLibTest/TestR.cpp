@@ -0,0 +1,118 @@
+#include "stdafx.h"
+#include "ContainerAPI.h"
+#include "ContainerException.h"
+#include "impl/Connection.h"
+#include "Utils.h"
+#include <chrono>
+
+using namespace dbc;
+
+extern std::string db_path;
+extern std::string pass;
+
+extern ContainerGuard cont;
+
+namespace
+{
+	// Creates the chain of nested folders "level 1/level 2/...", returns the deepest one
+	FolderGuard CreateChain(FolderGuard folder, int depth, std::string& path)
+	{
+		for (int level = 1; level <= depth; ++level)
+		{
+			folder = folder->CreateFolder("level " + std::to_string(level));
+			path += "/level " + std::to_string(level);
+		}
+		return folder;
+	}
+
+	int CountLinks(const std::string& condition)
+	{
+		Connection connection(db_path, false);
+		SQLQuery query(connection, "SELECT count(*) FROM FileSystemTree " + condition + ";");
+		query.Step();
+		return query.ColumnInt(0);
+	}
+}
+
+TEST(R_ClosureTableTest, PathAndIsChildOf)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+	std::string path;
+	FolderGuard deepest = CreateChain(root, 30, path);
+	FileGuard file = deepest->CreateFile("file");
+
+	EXPECT_EQ(path, deepest->Path());
+	EXPECT_EQ(path + "/file", file->Path());
+	EXPECT_TRUE(file->IsChildOf(*root));
+	EXPECT_TRUE(deepest->IsChildOf(*cont->GetElement("/level 1")));
+	EXPECT_FALSE(cont->GetElement("/level 1")->IsChildOf(*deepest));
+	EXPECT_FALSE(deepest->IsChildOf(*deepest));
+}
+
+TEST(R_ClosureTableTest, MoveAndRemove)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+	FolderGuard first = root->CreateFolder("first");
+	FolderGuard second = root->CreateFolder("second");
+	std::string path;
+	FolderGuard deepest = CreateChain(first, 5, path);
+	FileGuard file = deepest->CreateFile("file");
+
+	ElementGuard subtree = cont->GetElement("/first/level 1");
+	subtree->MoveToEntry(*second);
+	EXPECT_EQ("/second/level 1/level 2/level 3/level 4/level 5/file", file->Path());
+	EXPECT_TRUE(file->IsChildOf(*second));
+	EXPECT_FALSE(file->IsChildOf(*first));
+	EXPECT_THROW(second->MoveToEntry(*deepest), ContainerException); // Into own subtree
+
+	second->Remove();
+	cont.reset();
+	EXPECT_EQ(0, CountLinks("WHERE descendant_id NOT IN (SELECT id FROM FileSystem)"));
+	EXPECT_EQ(0, CountLinks("WHERE ancestor_id NOT IN (SELECT id FROM FileSystem)"));
+	EXPECT_EQ(3, CountLinks("")); // root, "first" and the link between them
+}
+
+TEST(R_ClosureTableTest, BuiltOnUpgrade)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	std::string path;
+	CreateChain(cont->GetRoot(), 10, path);
+	DatabaseDisconnect();
+	{
+		Connection connection(db_path, false);
+		connection.ExecQuery("DROP TRIGGER trg_FileSystem_insert;");
+		connection.ExecQuery("DROP TRIGGER trg_FileSystem_delete;");
+		connection.ExecQuery("DROP TRIGGER trg_FileSystem_move;");
+		connection.ExecQuery("DROP TRIGGER trg_FileStreams_insert;");
+		connection.ExecQuery("DROP TRIGGER trg_FileStreams_delete;");
+		connection.ExecQuery("DROP TRIGGER trg_FileStreams_update;");
+		connection.ExecQuery("DROP TABLE FileSystemTree;");
+		connection.ExecQuery("DROP TABLE FolderAggregates;");
+		connection.ExecQuery("UPDATE Sets SET schema_version = 1;");
+	}
+
+	ASSERT_NO_THROW(cont = Connect(db_path, pass));
+	EXPECT_EQ(path, cont->GetElement(path)->Path());
+	EXPECT_EQ(66, CountLinks("")); // 11 elements: 11 self links and 55 links between ancestors and descendants
+}
+
+// Not a test: prints the time of Path() and IsChildOf() calls in the deep hierarchy. Run with --gtest_also_run_disabled_tests
+TEST(R_ClosureTableTest, DISABLED_Benchmark_DeepPath)
+{
+	const int calls = 10000;
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+	std::string path;
+	FileGuard file = CreateChain(root, 25, path)->CreateFile("file");
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < calls; ++i)
+	{
+		file->Path();
+		file->IsChildOf(*root);
+	}
+	auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+	std::cout << calls << " calls of Path() and IsChildOf() at depth 26: " << elapsed << " ms" << std::endl;
+}
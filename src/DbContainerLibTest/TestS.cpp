@@ -0,0 +1,127 @@
+#include "stdafx.h"
+#include "ContainerAPI.h"
+#include "ContainerException.h"
+#include "impl/Connection.h"
+#include "impl/DentryCache.h"
+#include "Utils.h"
+#include <chrono>
+
+using namespace dbc;
+
+extern ContainerGuard cont;
+
+namespace
+{
+	const std::string s_dentriesDbPath = "dentries_test.db";
+
+	void PrepareDentriesDb(Connection& connection)
+	{
+		connection.ExecQuery("CREATE TABLE FileSystem(id INTEGER PRIMARY KEY NOT NULL, parent_id INTEGER, name TEXT, type INTEGER);");
+		connection.ExecQuery("INSERT INTO FileSystem(id, parent_id, name, type) VALUES (1, 0, '/', 1);");
+		connection.ExecQuery("INSERT INTO FileSystem(id, parent_id, name, type) VALUES (2, 1, 'file', 2);");
+	}
+}
+
+TEST(S_DentryCacheTest, HitsAndNegativeEntries)
+{
+	remove(s_dentriesDbPath.c_str());
+	Connection connection(s_dentriesDbPath, true);
+	PrepareDentriesDb(connection);
+	DentryCache dentries;
+	DentryCache::Dentry dentry;
+
+	EXPECT_TRUE(dentries.Lookup(connection, 1, "file", dentry));
+	EXPECT_EQ(2, dentry.id);
+	EXPECT_EQ(ElementTypeFile, dentry.type);
+	EXPECT_TRUE(dentries.Lookup(connection, 1, "file", dentry));
+	EXPECT_FALSE(dentries.Lookup(connection, 1, "missing", dentry));
+	EXPECT_FALSE(dentries.Lookup(connection, 1, "missing", dentry));
+	DentryCache::Statistics stats = dentries.GetStatistics();
+	EXPECT_EQ(2, stats.misses);
+	EXPECT_EQ(2, stats.hits);
+	EXPECT_EQ(2, stats.size);
+
+	// The change is not visible until the entry is invalidated
+	connection.ExecQuery("INSERT INTO FileSystem(id, parent_id, name, type) VALUES (3, 1, 'missing', 1);");
+	EXPECT_FALSE(dentries.Lookup(connection, 1, "missing", dentry));
+	dentries.Invalidate(1, "missing");
+	EXPECT_TRUE(dentries.Lookup(connection, 1, "missing", dentry));
+
+	dentries.InvalidateElement(2);
+	dentries.InvalidateElements(ElementsIds_st(&dentry.id, &dentry.id + 1));
+	EXPECT_EQ(0, dentries.GetStatistics().size);
+
+	// Uncommitted changes are not cached
+	{
+		TransactionGuard transaction = connection.StartTransaction();
+		EXPECT_TRUE(dentries.Lookup(connection, 1, "file", dentry));
+	}
+	EXPECT_EQ(0, dentries.GetStatistics().size);
+
+	dentries.SetCapacity(1);
+	dentries.Lookup(connection, 1, "file", dentry);
+	dentries.Lookup(connection, 1, "missing", dentry);
+	EXPECT_EQ(1, dentries.GetStatistics().size);
+
+	connection.Disconnect();
+	remove(s_dentriesDbPath.c_str());
+}
+
+TEST(S_DentryCacheTest, InvalidatedByChanges)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+	FolderGuard folder = root->CreateFolder("folder");
+	FolderGuard other = root->CreateFolder("other");
+
+	// Negative entries
+	EXPECT_FALSE(cont->GetElement("/folder/file"));
+	EXPECT_FALSE(folder->GetChild("file"));
+	FileGuard file = folder->CreateFile("file");
+	EXPECT_TRUE(cont->GetElement("/folder/file")->IsTheSame(*file));
+	EXPECT_TRUE(folder->GetChild("file")->IsTheSame(*file));
+
+	file->Rename("renamed");
+	EXPECT_FALSE(cont->GetElement("/folder/file"));
+	EXPECT_TRUE(cont->GetElement("/folder/renamed")->IsTheSame(*file));
+
+	folder->MoveToEntry(*other);
+	EXPECT_FALSE(cont->GetElement("/folder"));
+	EXPECT_TRUE(cont->GetElement("/other/folder/renamed")->IsTheSame(*file));
+
+	file->Remove();
+	EXPECT_FALSE(cont->GetElement("/other/folder/renamed"));
+	ElementGuards_vt created = folder->CreateChildren(ChildSpecs_vt(1, ChildSpec("renamed", ElementTypeFolder)));
+	EXPECT_EQ(ElementTypeFolder, cont->GetElement("/other/folder/renamed")->Type());
+
+	other->Remove();
+	EXPECT_FALSE(cont->GetElement("/other/folder/renamed"));
+	EXPECT_FALSE(cont->GetElement("/other"));
+
+	cont->GetRoot()->CreateFolder("other");
+	cont->Clear();
+	EXPECT_FALSE(cont->GetElement("/other"));
+}
+
+// Not a test: prints the time of the path resolution of the same paths. Run with --gtest_also_run_disabled_tests
+TEST(S_DentryCacheTest, DISABLED_Benchmark_GetElement)
+{
+	const int depth = 10;
+	const int lookups = 20000;
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard folder = cont->GetRoot();
+	std::string path;
+	for (int level = 0; level < depth; ++level)
+	{
+		folder = folder->CreateFolder("level " + std::to_string(level));
+		path += "/level " + std::to_string(level);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < lookups; ++i)
+	{
+		cont->GetElement(path);
+	}
+	auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+	std::cout << lookups << " lookups of the path with " << depth << " components: " << elapsed << " ms" << std::endl;
+}
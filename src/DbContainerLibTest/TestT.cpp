@@ -0,0 +1,117 @@
+#include "stdafx.h"
+#include "ContainerAPI.h"
+#include "ContainerException.h"
+#include "Utils.h"
+#include <chrono>
+#include <map>
+
+using namespace dbc;
+
+extern ContainerGuard cont;
+
+TEST(T_ElementsIteratorTest, ElementsFromListing)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+	FolderGuard folder = root->CreateFolder("folder", "folder meta");
+	FileGuard file = root->CreateFile("file", "file meta");
+	root->CreateSymLink("symlink", "/folder");
+	root->CreateDirectLink("directlink", file);
+
+	std::map<std::string, ElementGuard> listed;
+	DbcElementsIterator it = root->EnumFsEntries();
+	while (it->HasNext())
+	{
+		ElementGuard element = it->Next();
+		EXPECT_TRUE(element->GetParentEntry()->IsTheSame(*root));
+		listed[element->Name()] = element;
+	}
+	ASSERT_EQ(4, listed.size());
+
+	EXPECT_EQ(ElementTypeFolder, listed["folder"]->Type());
+	EXPECT_TRUE(listed["folder"]->IsTheSame(*folder));
+	EXPECT_EQ(folder->GetProperties().DateCreated(), listed["folder"]->GetProperties().DateCreated());
+	EXPECT_EQ("folder meta", listed["folder"]->GetProperties().Meta());
+	EXPECT_EQ("/folder", listed["folder"]->Path());
+	EXPECT_EQ(ElementTypeFile, listed["file"]->Type());
+	EXPECT_EQ("file meta", listed["file"]->GetProperties().Meta());
+	EXPECT_EQ(ElementTypeSymLink, listed["symlink"]->Type());
+	EXPECT_EQ("/folder", listed["symlink"]->AsSymLink()->TargetPath());
+	EXPECT_TRUE(listed["symlink"]->AsSymLink()->Target()->IsTheSame(*folder));
+	EXPECT_EQ(ElementTypeDirectLink, listed["directlink"]->Type());
+	EXPECT_TRUE(listed["directlink"]->AsDirectLink()->Target()->IsTheSame(*file));
+
+	// The listed elements are the full-fledged ones
+	listed["file"]->Rename("renamed");
+	EXPECT_EQ("renamed", file->Name());
+	listed["folder"]->AsFolder()->CreateFile("child");
+	EXPECT_TRUE(cont->GetElement("/folder/child"));
+}
+
+TEST(T_ElementsIteratorTest, ChangedAfterListing)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+	root->CreateFile("file", "old meta");
+
+	DbcElementsIterator it = root->EnumFsEntries();
+	root->GetChild("file")->SetMetaInformation("new meta");
+	ASSERT_TRUE(it->HasNext());
+	EXPECT_EQ("new meta", it->Next()->GetProperties().Meta()); // The properties are refreshed on reading
+
+	it->Rewind();
+	root->GetChild("file")->Remove();
+	ASSERT_TRUE(it->HasNext());
+	EXPECT_THROW(it->Next(), ContainerException);
+}
+
+TEST(T_ElementsIteratorTest, CreatedChildren)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+
+	ChildSpecs_vt children;
+	children.push_back(ChildSpec("folder", ElementTypeFolder, "folder meta"));
+	children.push_back(ChildSpec("symlink", ElementTypeSymLink, "/folder"));
+	ElementGuards_vt elements = root->CreateChildren(children);
+	ASSERT_EQ(2, elements.size());
+
+	EXPECT_EQ("/folder", elements[0]->Path());
+	EXPECT_EQ(root->GetChild("folder")->GetProperties().DateCreated(), elements[0]->GetProperties().DateCreated());
+	EXPECT_EQ("folder meta", elements[0]->GetProperties().Meta());
+	EXPECT_EQ("/folder", elements[1]->AsSymLink()->TargetPath());
+	EXPECT_EQ("/folder", root->GetChild("symlink")->AsSymLink()->TargetPath());
+}
+
+// Not a test: prints the time of listing a large folder with reading of the elements' properties. Run with --gtest_also_run_disabled_tests
+TEST(T_ElementsIteratorTest, DISABLED_Benchmark_ListFolder)
+{
+	const int elementsCount = 20000;
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard folder = cont->GetRoot()->CreateFolder("folder");
+	ChildSpecs_vt children;
+	for (int i = 0; i < elementsCount; ++i)
+	{
+		children.push_back(ChildSpec("file " + std::to_string(i), ElementTypeFile, "meta"));
+	}
+	folder->CreateChildren(children);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	size_t metaSize = 0;
+	DbcElementsIterator it = folder->EnumFsEntries();
+	while (it->HasNext())
+	{
+		metaSize += it->Next()->Name().size();
+	}
+	std::chrono::steady_clock::time_point listed = std::chrono::steady_clock::now();
+	it->Rewind();
+	while (it->HasNext())
+	{
+		metaSize += it->Next()->GetProperties().Meta().size();
+	}
+	std::chrono::steady_clock::time_point read = std::chrono::steady_clock::now();
+
+	EXPECT_LT(0, metaSize);
+	std::cout << elementsCount << " elements: listing with names " << std::chrono::duration_cast<std::chrono::milliseconds>(listed - start).count()
+		<< " ms, reading of the properties " << std::chrono::duration_cast<std::chrono::milliseconds>(read - listed).count() << " ms" << std::endl;
+}
@@ -0,0 +1,106 @@
+#include "stdafx.h"
+#include "ContainerAPI.h"
+#include "ContainerException.h"
+#include "impl/Connection.h"
+#include "Utils.h"
+#include <chrono>
+
+using namespace dbc;
+
+extern std::string db_path;
+extern std::string pass;
+extern ContainerGuard cont;
+
+TEST(U_ChangeGenerationTest, Connection)
+{
+	const std::string generationDbPath = "generation_test.db";
+	remove(generationDbPath.c_str());
+	Connection connection(generationDbPath, true);
+	connection.ExecQuery("CREATE TABLE Test(value INTEGER);");
+
+	uint64_t generation = connection.ChangeGeneration();
+	EXPECT_NE(0, generation);
+	EXPECT_EQ(generation, connection.ChangeGeneration());
+
+	connection.ExecQuery("INSERT INTO Test(value) VALUES (1);");
+	EXPECT_NE(generation, connection.ChangeGeneration());
+	generation = connection.ChangeGeneration();
+
+	connection.ExecQuery("UPDATE Test SET value = 2 WHERE value = 0;"); // Nothing is changed
+	EXPECT_EQ(generation, connection.ChangeGeneration());
+
+	{
+		TransactionGuard transaction = connection.StartTransaction();
+		connection.ExecQuery("INSERT INTO Test(value) VALUES (3);");
+		EXPECT_EQ(0, connection.ChangeGeneration());
+	}
+	EXPECT_NE(generation, connection.ChangeGeneration()); // The rolled back change is counted too
+
+	connection.Disconnect();
+	remove(generationDbPath.c_str());
+}
+
+TEST(U_ChangeGenerationTest, ElementsSeeChanges)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+	FileGuard file = root->CreateFile("file", "meta");
+	ElementGuard same = root->GetChild("file");
+	EXPECT_EQ("meta", file->GetProperties().Meta());
+	EXPECT_EQ("file", file->Name());
+
+	same->SetMetaInformation("new meta");
+	EXPECT_EQ("new meta", file->GetProperties().Meta());
+	same->Rename("renamed");
+	EXPECT_EQ("renamed", file->Name());
+	same->MoveToEntry(*root->CreateFolder("folder"));
+	EXPECT_EQ("/folder/renamed", file->Path());
+	same->Remove();
+	EXPECT_THROW(file->Name(), ContainerException);
+}
+
+TEST(U_ChangeGenerationTest, ExternalChanges)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	cont->GetRoot()->CreateFolder("folder");
+	ConnectionOptions options;
+	options.SetTrackExternalChanges(true);
+	options.SetDentryCacheSize(0);
+	ContainerGuard shared = Connect(db_path, pass, options);
+	EXPECT_TRUE(shared->GetConnectionOptions().TrackExternalChanges());
+
+	ElementGuard folder = shared->GetElement("/folder");
+	EXPECT_EQ("folder", folder->Name());
+	cont->GetElement("/folder")->Rename("changed"); // By the other connection
+	EXPECT_EQ("changed", folder->Name()); // PRAGMA data_version or the reload on every access with SQLite before 3.8.4
+}
+
+// Not a test: prints the time of repeated reading of the properties of the unchanged elements. Run with --gtest_also_run_disabled_tests
+TEST(U_ChangeGenerationTest, DISABLED_Benchmark_GetProperties)
+{
+	const int elementsCount = 1000;
+	const int repeats = 20;
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard folder = cont->GetRoot()->CreateFolder("folder");
+	ChildSpecs_vt children;
+	for (int i = 0; i < elementsCount; ++i)
+	{
+		children.push_back(ChildSpec("file " + std::to_string(i), ElementTypeFile, "meta"));
+	}
+	ElementGuards_vt elements = folder->CreateChildren(children);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	size_t metaSize = 0;
+	for (int i = 0; i < repeats; ++i)
+	{
+		for (auto& element : elements)
+		{
+			metaSize += element->GetProperties().Meta().size() + element->Name().size();
+		}
+	}
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	EXPECT_LT(0, metaSize);
+	std::cout << elementsCount * repeats << " reads of the properties and names: "
+		<< std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " ms" << std::endl;
+}
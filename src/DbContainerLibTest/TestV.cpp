@@ -0,0 +1,131 @@
+#include "stdafx.h"
+#include "ContainerAPI.h"
+#include "ContainerException.h"
+#include "Utils.h"
+#include <algorithm>
+#include <chrono>
+
+using namespace dbc;
+
+extern ContainerGuard cont;
+
+namespace
+{
+	std::vector<std::string> CreateNamedChildren(FolderGuard folder, int count)
+	{
+		std::vector<std::string> names;
+		ChildSpecs_vt children;
+		for (int i = 0; i < count; ++i)
+		{
+			names.push_back("child " + std::to_string(i));
+			children.push_back(ChildSpec(names.back(), i % 3 ? ElementTypeFile : ElementTypeFolder));
+		}
+		folder->CreateChildren(children);
+		std::sort(names.begin(), names.end());
+		return names;
+	}
+
+	std::vector<std::string> EnumNames(Iterator<ElementGuard>& it)
+	{
+		std::vector<std::string> names;
+		while (it.HasNext())
+		{
+			names.push_back(it.Next()->Name());
+		}
+		return names;
+	}
+}
+
+TEST(V_PagedElementsIteratorTest, SortedPages)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+	std::vector<std::string> names = CreateNamedChildren(root, 25);
+
+	for (size_t pageSize : { 1, 10, 25, 100 })
+	{
+		DbcPagedElementsIterator it = root->EnumFsEntriesPaged(pageSize);
+		EXPECT_FALSE(it->Empty());
+		EXPECT_EQ(25, it->Count());
+		EXPECT_EQ(names, EnumNames(*it));
+		EXPECT_EQ(names.back(), it->LastKey());
+		EXPECT_THROW(it->Next(), ContainerException);
+
+		it->Rewind();
+		EXPECT_EQ(names, EnumNames(*it));
+	}
+
+	DbcPagedElementsIterator empty = root->CreateFolder("empty")->EnumFsEntriesPaged();
+	EXPECT_TRUE(empty->Empty());
+	EXPECT_FALSE(empty->HasNext());
+	EXPECT_EQ(0, empty->Count());
+}
+
+TEST(V_PagedElementsIteratorTest, StartAfter)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+	std::vector<std::string> names = CreateNamedChildren(root, 25);
+
+	// Continue the enumeration from the last key
+	DbcPagedElementsIterator it = root->EnumFsEntriesPaged(4);
+	for (int i = 0; i < 6; ++i)
+	{
+		it->Next();
+	}
+	DbcPagedElementsIterator continued = root->EnumFsEntriesPaged(4, it->LastKey());
+	EXPECT_EQ(std::vector<std::string>(names.begin() + 6, names.end()), EnumNames(*continued));
+
+	DbcPagedElementsIterator last = root->EnumFsEntriesPaged(10, names.back());
+	EXPECT_TRUE(last->Empty());
+	DbcPagedElementsIterator before = root->EnumFsEntriesPaged(10, "a"); // The key doesn't have to exist
+	EXPECT_EQ(names, EnumNames(*before));
+}
+
+TEST(V_PagedElementsIteratorTest, ChangesDuringEnumeration)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+	root->CreateFile("b");
+	root->CreateFile("d");
+	root->CreateFile("f");
+	root->CreateFile("h");
+
+	DbcPagedElementsIterator it = root->EnumFsEntriesPaged(2);
+	EXPECT_EQ("b", it->Next()->Name());
+	root->CreateFile("a"); // Before the current key
+	root->CreateFile("c"); // Inside the fetched page
+	root->CreateFile("e");
+	root->GetChild("h")->Remove();
+	EXPECT_EQ("d", it->Next()->Name());
+	EXPECT_EQ("e", it->Next()->Name());
+	EXPECT_EQ("f", it->Next()->Name());
+	EXPECT_FALSE(it->HasNext());
+}
+
+// Not a test: prints the time to the first element of a large folder for the full and the paged enumerations. Run with --gtest_also_run_disabled_tests
+TEST(V_PagedElementsIteratorTest, DISABLED_Benchmark_FirstElement)
+{
+	const int elementsCount = 200000;
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard folder = cont->GetRoot()->CreateFolder("folder");
+	CreateNamedChildren(folder, elementsCount);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	DbcElementsIterator full = folder->EnumFsEntries();
+	full->Next();
+	std::chrono::steady_clock::time_point fullFirst = std::chrono::steady_clock::now();
+	full.reset();
+
+	std::chrono::steady_clock::time_point pagedStart = std::chrono::steady_clock::now();
+	DbcPagedElementsIterator paged = folder->EnumFsEntriesPaged();
+	paged->Next();
+	std::chrono::steady_clock::time_point pagedFirst = std::chrono::steady_clock::now();
+	size_t count = 1 + EnumNames(*paged).size();
+	std::chrono::steady_clock::time_point pagedEnd = std::chrono::steady_clock::now();
+
+	EXPECT_EQ(elementsCount, count);
+	std::cout << elementsCount << " elements: first element of the full listing " << std::chrono::duration_cast<std::chrono::milliseconds>(fullFirst - start).count()
+		<< " ms, of the paged one " << std::chrono::duration_cast<std::chrono::milliseconds>(pagedFirst - pagedStart).count()
+		<< " ms, the whole paged listing " << std::chrono::duration_cast<std::chrono::milliseconds>(pagedEnd - pagedStart).count() << " ms" << std::endl;
+}
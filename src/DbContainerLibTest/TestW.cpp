@@ -0,0 +1,175 @@
+#include "stdafx.h"
+#include "ContainerAPI.h"
+#include "ContainerException.h"
+#include "impl/Connection.h"
+#include "Utils.h"
+#include <chrono>
+
+using namespace dbc;
+
+extern std::string db_path;
+extern ContainerGuard cont;
+
+namespace
+{
+	std::vector<std::string> EnumNames(Folder& folder, const ListFilter& filter)
+	{
+		std::vector<std::string> names;
+		DbcElementsIterator it = folder.EnumFsEntries(filter);
+		while (it->HasNext())
+		{
+			names.push_back(it->Next()->Name());
+		}
+		return names;
+	}
+
+	void SetTimes(const std::string& name, time_t created, time_t modified)
+	{
+		Connection connection(db_path, false);
+		SQLQuery query(connection, "UPDATE FileSystem SET created = ?, modified = ? WHERE name = ?;");
+		query.BindInt64(1, created);
+		query.BindInt64(2, modified);
+		query.BindText(3, name);
+		query.Step();
+	}
+
+	typedef std::vector<std::string> Names_vt;
+}
+
+TEST(W_ListFilterTest, TypesAndNames)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+	root->CreateFolder("docs");
+	root->CreateFile("doc.txt");
+	root->CreateFile("doc.md");
+	root->CreateFile("image.png");
+	root->CreateSymLink("doc link", "/docs");
+
+	ListFilter filter;
+	filter.SetSortOrder(ListSortName);
+	EXPECT_EQ(Names_vt({ "doc link", "doc.md", "doc.txt", "docs", "image.png" }), EnumNames(*root, filter));
+
+	filter.SetTypes(ListTypeFiles);
+	EXPECT_EQ(Names_vt({ "doc.md", "doc.txt", "image.png" }), EnumNames(*root, filter));
+	filter.SetTypes(ListTypeFolders | ListTypeSymLinks);
+	EXPECT_EQ(Names_vt({ "doc link", "docs" }), EnumNames(*root, filter));
+	filter.SetTypes(0);
+	EXPECT_TRUE(EnumNames(*root, filter).empty());
+
+	filter.SetTypes(ListTypeAll);
+	filter.SetNamePrefix("doc.");
+	EXPECT_EQ(Names_vt({ "doc.md", "doc.txt" }), EnumNames(*root, filter));
+	filter.SetNamePrefix("x");
+	EXPECT_TRUE(EnumNames(*root, filter).empty());
+
+	filter.SetNameGlob("*.t?t");
+	EXPECT_EQ(Names_vt({ "doc.txt" }), EnumNames(*root, filter));
+	filter.SetNameGlob("doc*");
+	filter.SetTypes(ListTypeFiles | ListTypeFolders);
+	filter.SetSortOrder(ListSortNameDesc);
+	EXPECT_EQ(Names_vt({ "docs", "doc.txt", "doc.md" }), EnumNames(*root, filter));
+	filter.SetNameGlob("[di]*");
+	filter.SetLimit(2);
+	EXPECT_EQ(Names_vt({ "image.png", "docs" }), EnumNames(*root, filter));
+
+	EXPECT_EQ(5, root->EnumFsEntries(ListFilter())->Count());
+}
+
+TEST(W_ListFilterTest, TimeRanges)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+	root->CreateFile("old");
+	root->CreateFile("recent");
+	root->CreateFile("new");
+	SetTimes("old", 1000, 2000);
+	SetTimes("recent", 1500, 5000);
+	SetTimes("new", 4000, 4000);
+
+	ListFilter filter;
+	filter.SetModifiedRange(3000, 5000);
+	filter.SetSortOrder(ListSortModified);
+	EXPECT_EQ(Names_vt({ "new", "recent" }), EnumNames(*root, filter));
+	filter.SetSortOrder(ListSortModifiedDesc);
+	EXPECT_EQ(Names_vt({ "recent", "new" }), EnumNames(*root, filter));
+
+	filter.SetCreatedRange(0, 1500);
+	EXPECT_EQ(Names_vt({ "recent" }), EnumNames(*root, filter));
+
+	filter = ListFilter();
+	filter.SetCreatedRange(1000, std::numeric_limits<time_t>::max());
+	filter.SetSortOrder(ListSortCreatedDesc);
+	filter.SetLimit(2);
+	EXPECT_EQ(Names_vt({ "new", "recent" }), EnumNames(*root, filter));
+}
+
+TEST(W_ListFilterTest, QueriesUseIndexes)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	DatabaseDisconnect();
+	Connection connection(db_path, false);
+	const char* queries[] = {
+		"SELECT id, meta FROM FileSystem WHERE parent_id = 1 AND type IN (2) ORDER BY name;",
+		"SELECT id, meta FROM FileSystem WHERE parent_id = 1 AND modified BETWEEN 1 AND 2 ORDER BY modified, name;",
+		"SELECT id, meta FROM FileSystem WHERE parent_id = 1 AND created BETWEEN 1 AND 2;",
+		"SELECT id, meta FROM FileSystem WHERE parent_id = 1 AND name >= 'a' AND name < 'b';"
+	};
+	for (const char* sql : queries)
+	{
+		SQLQuery query(connection, std::string("EXPLAIN QUERY PLAN ") + sql);
+		std::string plan;
+		while (query.Step())
+		{
+			std::string detail;
+			query.ColumnText(3, detail);
+			plan += detail + "\n";
+		}
+		EXPECT_NE(std::string::npos, plan.find("INDEX idx_FileSystem_parent_")) << sql << "\n" << plan;
+		EXPECT_EQ(std::string::npos, plan.find("TEMP B-TREE")) << sql << "\n" << plan;
+	}
+	connection.Disconnect();
+	DatabaseConnect();
+}
+
+// Not a test: compares filtering of the children in the query and after the listing. Run with --gtest_also_run_disabled_tests
+TEST(W_ListFilterTest, DISABLED_Benchmark_RecentFiles)
+{
+	const int elementsCount = 50000;
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard folder = cont->GetRoot()->CreateFolder("folder");
+	ChildSpecs_vt children;
+	for (int i = 0; i < elementsCount; ++i)
+	{
+		children.push_back(ChildSpec("child " + std::to_string(i), i % 2 ? ElementTypeFile : ElementTypeFolder));
+	}
+	folder->CreateChildren(children);
+	{
+		Connection connection(db_path, false);
+		connection.ExecQuery("UPDATE FileSystem SET modified = modified - 7200 WHERE parent_id != 1 AND name NOT LIKE 'child 1%';");
+	}
+	time_t hourAgo = ::time(nullptr) - 3600;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	size_t filtered = 0;
+	DbcElementsIterator it = folder->EnumFsEntries();
+	while (it->HasNext())
+	{
+		ElementGuard element = it->Next();
+		if (element->Type() == ElementTypeFile && element->GetProperties().DateModified() >= hourAgo)
+		{
+			++filtered;
+		}
+	}
+	std::chrono::steady_clock::time_point listed = std::chrono::steady_clock::now();
+
+	ListFilter filter;
+	filter.SetTypes(ListTypeFiles);
+	filter.SetModifiedRange(hourAgo, std::numeric_limits<time_t>::max());
+	size_t pushed = folder->EnumFsEntries(filter)->Count();
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	EXPECT_EQ(filtered, pushed);
+	std::cout << pushed << " of " << elementsCount << " children: filtering after the listing " << std::chrono::duration_cast<std::chrono::milliseconds>(listed - start).count()
+		<< " ms, in the query " << std::chrono::duration_cast<std::chrono::milliseconds>(end - listed).count() << " ms" << std::endl;
+}
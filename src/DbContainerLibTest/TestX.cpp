@@ -0,0 +1,174 @@
+#include "stdafx.h"
+#include "ContainerAPI.h"
+#include "ContainerException.h"
+#include "impl/Connection.h"
+#include "Utils.h"
+#include <chrono>
+
+using namespace dbc;
+
+extern std::string db_path;
+extern std::string pass;
+extern ContainerGuard cont;
+
+namespace
+{
+	void WriteData(FileGuard file, const std::string& data)
+	{
+		std::stringstream strm;
+		strm << data;
+		file->Write(strm, data.size());
+	}
+
+	// Compares the maintained aggregates with the ones counted from scratch
+	int CountWrongAggregates()
+	{
+		Connection connection(db_path, false);
+		SQLQuery query(connection, "SELECT count(*) FROM FileSystem AS folders LEFT JOIN FolderAggregates ON FolderAggregates.folder_id = folders.id "
+			"WHERE folders.type = 1 AND (FolderAggregates.folder_id IS NULL "
+			"OR FolderAggregates.children != (SELECT count(*) FROM FileSystem AS children WHERE children.parent_id = folders.id) "
+			"OR FolderAggregates.descendants != (SELECT count(*) FROM FileSystemTree WHERE ancestor_id = folders.id AND depth > 0) "
+			"OR FolderAggregates.total_size != (SELECT IFNULL(SUM(FileStreams.used), 0) FROM FileSystemTree "
+			"JOIN FileStreams ON FileStreams.file_id = FileSystemTree.descendant_id WHERE FileSystemTree.ancestor_id = folders.id));");
+		query.Step();
+		int wrong = query.ColumnInt(0);
+		query.Prepare("SELECT count(*) FROM FolderAggregates WHERE folder_id NOT IN (SELECT id FROM FileSystem WHERE type = 1);");
+		query.Step();
+		return wrong + query.ColumnInt(0);
+	}
+}
+
+TEST(X_FolderAggregatesTest, CreateWriteClear)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+	FolderGuard folder = root->CreateFolder("folder");
+	FolderGuard nested = folder->CreateFolder("nested");
+	FileGuard file = nested->CreateFile("file");
+	folder->CreateSymLink("link", "/folder/nested");
+
+	EXPECT_EQ(2, folder->ChildrenCount());
+	EXPECT_EQ(3, folder->DescendantCount());
+	EXPECT_EQ(4, root->DescendantCount());
+	EXPECT_EQ(0, root->TotalSize());
+	EXPECT_FALSE(nested->CreateFolder("empty")->HasChildren());
+	EXPECT_TRUE(nested->HasChildren());
+
+	WriteData(file, std::string(1000, 'a'));
+	EXPECT_EQ(1000, nested->TotalSize());
+	EXPECT_EQ(1000, folder->TotalSize());
+	EXPECT_EQ(1000, root->TotalSize());
+	WriteData(file, "shorter");
+	EXPECT_EQ(7, root->TotalSize());
+	EXPECT_EQ(0, CountWrongAggregates());
+
+	file->Clear();
+	EXPECT_EQ(0, root->TotalSize());
+
+	ChildSpecs_vt children;
+	children.push_back(ChildSpec("a", ElementTypeFile));
+	children.push_back(ChildSpec("b", ElementTypeFolder));
+	nested->CreateChildren(children);
+	EXPECT_EQ(4, nested->ChildrenCount());
+	EXPECT_EQ(7, root->DescendantCount());
+	EXPECT_EQ(0, CountWrongAggregates());
+}
+
+TEST(X_FolderAggregatesTest, MoveAndRemove)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+	FolderGuard first = root->CreateFolder("first");
+	FolderGuard second = root->CreateFolder("second");
+	FolderGuard subtree = first->CreateFolder("subtree");
+	WriteData(subtree->CreateFile("file 1"), "12345");
+	WriteData(subtree->CreateFolder("nested")->CreateFile("file 2"), "123");
+	FileGuard single = first->CreateFile("single");
+	WriteData(single, "12");
+
+	subtree->MoveToEntry(*second);
+	EXPECT_EQ(1, first->DescendantCount());
+	EXPECT_EQ(2, first->TotalSize());
+	EXPECT_EQ(4, second->DescendantCount());
+	EXPECT_EQ(8, second->TotalSize());
+	single->MoveToEntry(*subtree);
+	EXPECT_EQ(0, first->TotalSize());
+	EXPECT_EQ(10, second->TotalSize());
+	EXPECT_EQ(10, root->TotalSize());
+	EXPECT_EQ(0, CountWrongAggregates());
+
+	single->Remove();
+	EXPECT_EQ(8, second->TotalSize());
+	EXPECT_EQ(4, second->DescendantCount());
+	subtree->Remove();
+	EXPECT_EQ(0, second->DescendantCount());
+	EXPECT_EQ(0, second->ChildrenCount());
+	EXPECT_EQ(0, root->TotalSize());
+	EXPECT_EQ(2, root->DescendantCount());
+	EXPECT_THROW(subtree->TotalSize(), ContainerException);
+	EXPECT_EQ(0, CountWrongAggregates());
+
+	cont->Clear();
+	EXPECT_EQ(0, cont->GetRoot()->DescendantCount());
+	EXPECT_EQ(0, CountWrongAggregates());
+}
+
+TEST(X_FolderAggregatesTest, UpgradeCountsExistingFolders)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard folder = cont->GetRoot()->CreateFolder("folder");
+	WriteData(folder->CreateFolder("nested")->CreateFile("file"), "123456");
+	DatabaseDisconnect();
+	{
+		Connection connection(db_path, false);
+		connection.ExecQuery("DROP TRIGGER trg_FileStreams_insert;");
+		connection.ExecQuery("DROP TRIGGER trg_FileStreams_delete;");
+		connection.ExecQuery("DROP TRIGGER trg_FileStreams_update;");
+		connection.ExecQuery("DROP TABLE FolderAggregates;");
+		connection.ExecQuery("UPDATE Sets SET schema_version = 3;");
+	}
+
+	ASSERT_NO_THROW(cont = Connect(db_path, pass));
+	EXPECT_EQ(0, CountWrongAggregates());
+	EXPECT_EQ(6, cont->GetElement("/folder")->AsFolder()->TotalSize());
+	EXPECT_EQ(3, cont->GetRoot()->DescendantCount());
+}
+
+// Not a test: compares the folder size by walking the tree with the maintained aggregate. Run with --gtest_also_run_disabled_tests
+TEST(X_FolderAggregatesTest, DISABLED_Benchmark_FolderSize)
+{
+	const int foldersCount = 100;
+	const int filesCount = 100;
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot()->CreateFolder("root");
+	for (int i = 0; i < foldersCount; ++i)
+	{
+		FolderGuard folder = root->CreateFolder("folder " + std::to_string(i));
+		ChildSpecs_vt children;
+		for (int j = 0; j < filesCount; ++j)
+		{
+			children.push_back(ChildSpec("file " + std::to_string(j), ElementTypeFile));
+		}
+		ElementGuards_vt files = folder->CreateChildren(children);
+		WriteData(std::dynamic_pointer_cast<File>(files.front()), "data");
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	uint64_t walked = 0;
+	DbcElementsIterator folders = root->EnumFsEntries();
+	while (folders->HasNext())
+	{
+		DbcElementsIterator files = folders->Next()->AsFolder()->EnumFsEntries();
+		while (files->HasNext())
+		{
+			walked += files->Next()->AsFile()->Size();
+		}
+	}
+	std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+	uint64_t aggregated = root->TotalSize();
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	EXPECT_EQ(walked, aggregated);
+	std::cout << foldersCount * filesCount << " files: walking " << std::chrono::duration_cast<std::chrono::milliseconds>(middle - start).count()
+		<< " ms, aggregate " << std::chrono::duration_cast<std::chrono::microseconds>(end - middle).count() << " us" << std::endl;
+}
@@ -0,0 +1,106 @@
+#include "stdafx.h"
+#include "ContainerAPI.h"
+#include "ContainerException.h"
+#include "impl/Connection.h"
+#include "Utils.h"
+#include <chrono>
+
+using namespace dbc;
+
+extern std::string db_path;
+extern std::string pass;
+extern ContainerGuard cont;
+
+namespace
+{
+	void WriteData(FileGuard file, const std::string& data)
+	{
+		std::stringstream strm;
+		strm << data;
+		file->Write(strm, data.size());
+	}
+
+	// Compares the stored sizes with the bytes used by the streams
+	int CountWrongSizes()
+	{
+		Connection connection(db_path, false);
+		SQLQuery query(connection, "SELECT count(*) FROM FileSystem "
+			"WHERE data_size != (SELECT IFNULL(SUM(used), 0) FROM FileStreams WHERE file_id = FileSystem.id);");
+		query.Step();
+		return query.ColumnInt(0);
+	}
+}
+
+TEST(Y_FileSizeTest, StoredSize)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+	FileGuard file = root->CreateFile("file");
+	FileGuard other = root->CreateFile("other");
+	EXPECT_EQ(0, file->Size());
+	EXPECT_TRUE(file->IsEmpty());
+
+	WriteData(file, std::string(5000, 'a'));
+	EXPECT_EQ(5000, file->Size());
+	WriteData(other, std::string(300, 'b'));
+	EXPECT_EQ(300, other->Size());
+	WriteData(file, "short");
+	EXPECT_EQ(5, file->Size());
+	EXPECT_EQ(5, root->GetChild("file")->AsFile()->Size());
+	EXPECT_EQ(0, CountWrongSizes());
+
+	// The streams of the cleared file are reused by the next writes
+	file->Clear();
+	EXPECT_EQ(0, file->Size());
+	WriteData(root->CreateFile("third"), std::string(4000, 'c'));
+	EXPECT_EQ(0, CountWrongSizes());
+
+	other->Remove();
+	EXPECT_EQ(0, CountWrongSizes());
+	EXPECT_EQ(4000, root->TotalSize());
+}
+
+TEST(Y_FileSizeTest, UpgradeStoresSizes)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	WriteData(cont->GetRoot()->CreateFile("file"), "123456");
+	DatabaseDisconnect();
+	{
+		Connection connection(db_path, false);
+		connection.ExecQuery("UPDATE FileSystem SET data_size = 0;");
+		connection.ExecQuery("UPDATE Sets SET schema_version = 4;");
+	}
+
+	ASSERT_NO_THROW(cont = Connect(db_path, pass));
+	EXPECT_EQ(0, CountWrongSizes());
+	EXPECT_EQ(6, cont->GetElement("/file")->AsFile()->Size());
+}
+
+// Not a test: prints the time of Size() calls of the fragmented file. Run with --gtest_also_run_disabled_tests
+TEST(Y_FileSizeTest, DISABLED_Benchmark_Size)
+{
+	const int calls = 10000;
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+	FileGuard file = root->CreateFile("file");
+	// Interleaved writes of two files make the streams chain of the first one long
+	FileGuard other = root->CreateFile("other");
+	for (int i = 0; i < 200; ++i)
+	{
+		file->Open(WriteAccess);
+		WriteData(file, std::string(100 * (i + 1), 'a'));
+		file->Close();
+		WriteData(other, std::string(100 * (i + 1), 'b'));
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	uint64_t total = 0;
+	for (int i = 0; i < calls; ++i)
+	{
+		total += file->Size();
+	}
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	EXPECT_EQ(calls * file->Size(), total);
+	std::cout << calls << " Size() calls: " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " ms" << std::endl;
+}
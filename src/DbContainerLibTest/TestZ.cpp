@@ -0,0 +1,97 @@
+#include "stdafx.h"
+#include "ContainerAPI.h"
+#include "ContainerException.h"
+#include "Utils.h"
+#include <chrono>
+
+using namespace dbc;
+
+extern ContainerGuard cont;
+
+TEST(Z_IdentityMapTest, LookupsShareObject)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+	FolderGuard folder = root->CreateFolder("folder");
+	FileGuard file = folder->CreateFile("file");
+
+	EXPECT_EQ(root, cont->GetRoot());
+	EXPECT_EQ(folder, cont->GetElement("/folder"));
+	EXPECT_EQ(folder, root->GetChild("folder"));
+	EXPECT_EQ(folder, file->GetParentEntry());
+	EXPECT_EQ(file, cont->GetElement("/folder/file"));
+	DbcElementsIterator it = folder->EnumFsEntries();
+	ASSERT_TRUE(it->HasNext());
+	EXPECT_EQ(file, it->Next());
+	DbcPagedElementsIterator paged = folder->EnumFsEntriesPaged(10);
+	ASSERT_TRUE(paged->HasNext());
+	EXPECT_EQ(file, paged->Next());
+
+	// Clone is a separate handle, e.g. to open the file once more
+	FileGuard clone = file->Clone();
+	EXPECT_NE(file, clone);
+	EXPECT_TRUE(file->IsTheSame(*clone));
+}
+
+TEST(Z_IdentityMapTest, ChangesSeenByHolders)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FileGuard file = cont->GetRoot()->CreateFile("file");
+	ElementGuard other = cont->GetElement("/file");
+
+	other->Rename("renamed");
+	EXPECT_EQ("renamed", file->Name());
+	other->SetMetaInformation("meta");
+	EXPECT_EQ("meta", file->GetProperties().Meta());
+	EXPECT_EQ(other, cont->GetElement("/renamed"));
+	EXPECT_FALSE(cont->GetElement("/file"));
+}
+
+TEST(Z_IdentityMapTest, RemovedIdReused)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+	FolderGuard removed = root->CreateFolder("removed");
+	FolderGuard nested = removed->CreateFolder("nested");
+	removed->Remove();
+	EXPECT_THROW(nested->Name(), ContainerException);
+
+	// The ids of the removed elements are reused by the new ones
+	root->CreateFolder("folder");
+	root->CreateFile("file");
+	ElementGuard folder = cont->GetElement("/folder");
+	ElementGuard file = cont->GetElement("/file");
+	ASSERT_TRUE(folder && file);
+	EXPECT_NE(removed, folder);
+	EXPECT_NE(nested, file);
+	EXPECT_EQ(ElementTypeFile, file->Type());
+	EXPECT_EQ("file", file->Name());
+
+	cont->Clear();
+	EXPECT_FALSE(cont->GetElement("/folder"));
+	EXPECT_NE(root, cont->GetRoot());
+}
+
+// Not a test: prints the time of the lookups of the held and of the released element. Run with --gtest_also_run_disabled_tests
+TEST(Z_IdentityMapTest, DISABLED_Benchmark_Lookups)
+{
+	const int lookups = 20000;
+	ASSERT_TRUE(DatabasePrepare());
+	cont->GetRoot()->CreateFolder("folder")->CreateFile("file");
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int i = 0; i < lookups; ++i)
+	{
+		cont->GetElement("/folder/file");
+	}
+	std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+	ElementGuard held = cont->GetElement("/folder/file");
+	for (int i = 0; i < lookups; ++i)
+	{
+		cont->GetElement("/folder/file");
+	}
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	std::cout << lookups << " lookups: released " << std::chrono::duration_cast<std::chrono::milliseconds>(middle - start).count()
+		<< " ms, held " << std::chrono::duration_cast<std::chrono::milliseconds>(end - middle).count() << " ms" << std::endl;
+}
@@ -0,0 +1,120 @@
+#include "stdafx.h"
+#include "ContainerAPI.h"
+#include "ContainerException.h"
+#include "Utils.h"
+#include <chrono>
+
+using namespace dbc;
+
+extern ContainerGuard cont;
+
+TEST(ZA_InfoBatchTest, GetInfoBatch)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+	FolderGuard folder = root->CreateFolder("folder", "\xD0\xBC\xD0\xB5\xD1\x82\xD0\xB0"); // 4 characters, 8 bytes
+	FileGuard file = folder->CreateFile("file");
+	std::stringstream data("0123456789");
+	file->Write(data, 10);
+	SymLinkGuard link = root->CreateSymLink("link", "/folder/file");
+
+	std::vector<int64_t> ids = { file->Id(), 1000000, link->Id(), folder->Id(), file->Id() };
+	ElementSummaries_vt summaries = cont->GetInfoBatch(ids);
+	ASSERT_EQ(4, summaries.size()); // The missing element is skipped, the duplicate is not
+	EXPECT_EQ(file->Id(), summaries[0].ID);
+	EXPECT_EQ(folder->Id(), summaries[0].ParentID);
+	EXPECT_EQ("file", summaries[0].Name);
+	EXPECT_EQ(ElementTypeFile, summaries[0].Type);
+	EXPECT_EQ(10, summaries[0].Size);
+	EXPECT_EQ(0, summaries[0].MetaLength);
+	EXPECT_EQ(file->GetProperties().DateModified(), summaries[0].Modified);
+	EXPECT_EQ(file->GetProperties().DateCreated(), summaries[0].Created);
+
+	EXPECT_EQ(ElementTypeSymLink, summaries[1].Type);
+	EXPECT_EQ(0, summaries[1].MetaLength);
+	EXPECT_EQ("folder", summaries[2].Name);
+	EXPECT_EQ(root->Id(), summaries[2].ParentID);
+	EXPECT_EQ(8, summaries[2].MetaLength);
+	EXPECT_EQ(file->Id(), summaries[3].ID);
+
+	EXPECT_TRUE(cont->GetInfoBatch(std::vector<int64_t>()).empty());
+}
+
+TEST(ZA_InfoBatchTest, ListWithInfo)
+{
+	const size_t childrenCount = 1200; // More than one chunk of the ids
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard folder = cont->GetRoot()->CreateFolder("folder");
+	EXPECT_TRUE(folder->ListWithInfo().empty());
+
+	ChildSpecs_vt children;
+	for (size_t i = 0; i < childrenCount; ++i)
+	{
+		children.push_back(ChildSpec("child " + std::to_string(childrenCount - i), i % 2 ? ElementTypeFile : ElementTypeFolder));
+	}
+	folder->CreateChildren(children);
+
+	ElementSummaries_vt listed = folder->ListWithInfo();
+	ASSERT_EQ(childrenCount, listed.size());
+	std::vector<int64_t> ids;
+	for (size_t i = 0; i < listed.size(); ++i)
+	{
+		EXPECT_EQ(folder->Id(), listed[i].ParentID);
+		if (i > 0)
+		{
+			EXPECT_LT(listed[i - 1].Name, listed[i].Name);
+		}
+		ids.push_back(listed[i].ID);
+	}
+
+	ElementSummaries_vt batch = cont->GetInfoBatch(ids);
+	ASSERT_EQ(childrenCount, batch.size());
+	for (size_t i = 0; i < batch.size(); ++i)
+	{
+		EXPECT_EQ(listed[i].ID, batch[i].ID);
+		EXPECT_EQ(listed[i].Name, batch[i].Name);
+		EXPECT_EQ(listed[i].Type, batch[i].Type);
+	}
+
+	folder->Remove();
+	EXPECT_THROW(folder->ListWithInfo(), ContainerException);
+	EXPECT_TRUE(cont->GetInfoBatch(ids).empty());
+}
+
+// Not a test: compares reading the properties of the children one by one with ListWithInfo(). Run with --gtest_also_run_disabled_tests
+TEST(ZA_InfoBatchTest, DISABLED_Benchmark_ListWithInfo)
+{
+	const int childrenCount = 5000;
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard folder = cont->GetRoot()->CreateFolder("folder");
+	ChildSpecs_vt children;
+	for (int i = 0; i < childrenCount; ++i)
+	{
+		children.push_back(ChildSpec("child " + std::to_string(i), i % 2 ? ElementTypeFile : ElementTypeFolder));
+	}
+	folder->CreateChildren(children);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	uint64_t total = 0;
+	DbcElementsIterator it = folder->EnumFsEntries();
+	while (it->HasNext())
+	{
+		ElementGuard element = it->Next();
+		total += element->Name().size() + element->GetProperties().Meta().size();
+		if (element->Type() == ElementTypeFile)
+		{
+			total += element->AsFile()->Size();
+		}
+	}
+	std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+	uint64_t batched = 0;
+	for (const ElementSummary& summary : folder->ListWithInfo())
+	{
+		batched += summary.Name.size() + summary.MetaLength + summary.Size;
+	}
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	EXPECT_EQ(total, batched);
+	std::cout << childrenCount << " children: one by one " << std::chrono::duration_cast<std::chrono::milliseconds>(middle - start).count()
+		<< " ms, ListWithInfo " << std::chrono::duration_cast<std::chrono::milliseconds>(end - middle).count() << " ms" << std::endl;
+}
@@ -0,0 +1,120 @@
+#include "stdafx.h"
+#include "ContainerAPI.h"
+#include "ContainerException.h"
+#include "impl/Connection.h"
+#include "Utils.h"
+
+using namespace dbc;
+
+extern std::string db_path;
+extern std::string pass;
+
+extern ContainerGuard cont;
+
+namespace
+{
+	int CountMetaRows(Connection& connection)
+	{
+		SQLQuery query(connection, "SELECT count(*) FROM ElementsMeta;");
+		query.Step();
+		return query.ColumnInt(0);
+	}
+}
+
+TEST(ZB_MetaTableTest, MetaIsOutOfTheRow)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+	const std::string bigMeta(100000, 'm');
+	FolderGuard folder = root->CreateFolder("folder", bigMeta);
+	FileGuard file = folder->CreateFile("file", "file meta");
+	SymLinkGuard link = root->CreateSymLink("link", "/folder/file");
+	DirectLinkGuard directLink = root->CreateDirectLink("direct", file);
+	DatabaseDisconnect();
+
+	{
+		Connection connection(db_path, false);
+		SQLQuery query(connection, "SELECT count(*) FROM FileSystem WHERE meta IS NOT NULL AND meta != '';");
+		ASSERT_TRUE(query.Step());
+		EXPECT_EQ(0, query.ColumnInt(0));
+		EXPECT_EQ(2, CountMetaRows(connection));
+		query.Prepare("SELECT target FROM FileSystem WHERE name = 'link';");
+		ASSERT_TRUE(query.Step());
+		std::string target;
+		query.ColumnText(0, target);
+		EXPECT_EQ("/folder/file", target);
+	}
+
+	DatabaseConnect();
+	EXPECT_EQ(bigMeta, cont->GetElement("/folder")->GetProperties().Meta());
+	EXPECT_EQ("/folder/file", cont->GetElement("/link")->AsSymLink()->TargetPath());
+	EXPECT_EQ("file meta", cont->GetElement("/link")->GetProperties().Meta()); // The meta of the target
+	EXPECT_EQ("file meta", cont->GetElement("/direct")->GetProperties().Meta());
+
+	DbcElementsIterator it = cont->GetRoot()->EnumFsEntries();
+	while (it->HasNext())
+	{
+		ElementGuard element = it->Next();
+		if (element->Type() == ElementTypeFolder)
+		{
+			EXPECT_EQ(bigMeta, element->GetProperties().Meta());
+		}
+	}
+}
+
+TEST(ZB_MetaTableTest, SetAndRemoveMeta)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard folder = cont->GetRoot()->CreateFolder("folder");
+	FileGuard file = folder->CreateFile("file");
+	EXPECT_TRUE(file->GetProperties().Meta().empty());
+
+	file->SetMetaInformation("new meta");
+	EXPECT_EQ("new meta", file->GetProperties().Meta());
+	FileGuard clone = file->Clone();
+	EXPECT_EQ("new meta", clone->GetProperties().Meta());
+	file->SetMetaInformation("");
+	EXPECT_TRUE(clone->GetProperties().Meta().empty());
+
+	file->SetMetaInformation("meta");
+	folder->SetMetaInformation("folder meta");
+	SymLinkGuard link = cont->GetRoot()->CreateSymLink("link", "/folder/file");
+	link->SetMetaInformation("linked meta");
+	EXPECT_EQ("/folder/file", link->TargetPath());
+	EXPECT_EQ("linked meta", file->GetProperties().Meta());
+
+	folder->Remove();
+	Connection connection(db_path, false);
+	EXPECT_EQ(0, CountMetaRows(connection));
+}
+
+TEST(ZB_MetaTableTest, UpgradeMovesMeta)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+	root->CreateFolder("folder");
+	root->CreateSymLink("link", "/folder");
+	DatabaseDisconnect();
+
+	{
+		// The layout of the schema version 5: the meta and the targets are in FileSystem.meta
+		Connection connection(db_path, false);
+		connection.ExecQuery("UPDATE FileSystem SET meta = 'folder meta' WHERE name = 'folder';");
+		connection.ExecQuery("UPDATE FileSystem SET meta = target, target = NULL WHERE name = 'link';");
+		connection.ExecQuery("DELETE FROM ElementsMeta;");
+		connection.ExecQuery("UPDATE Sets SET schema_version = 5 WHERE id = 1;");
+	}
+
+	ASSERT_NO_THROW(cont = Connect(db_path, pass));
+	EXPECT_EQ("folder meta", cont->GetElement("/folder")->GetProperties().Meta());
+	ElementGuard link = cont->GetElement("/link");
+	ASSERT_NE(nullptr, link.get());
+	EXPECT_EQ("/folder", link->AsSymLink()->TargetPath());
+	EXPECT_EQ("folder meta", link->GetProperties().Meta());
+	cont.reset();
+
+	Connection connection(db_path, false);
+	SQLQuery query(connection, "SELECT count(*) FROM FileSystem WHERE meta IS NOT NULL;");
+	ASSERT_TRUE(query.Step());
+	EXPECT_EQ(0, query.ColumnInt(0));
+}
@@ -0,0 +1,173 @@
+#include "stdafx.h"
+#include "ContainerAPI.h"
+#include "ContainerException.h"
+#include "impl/Connection.h"
+#include "impl/FreeExtentsIndex.h"
+#include "Utils.h"
+#include <chrono>
+
+using namespace dbc;
+
+extern ContainerGuard cont;
+
+namespace
+{
+	const std::string s_extentsDbPath = "extents_test.db";
+
+	void PrepareExtentsDb(Connection& connection)
+	{
+		connection.ExecQuery("CREATE TABLE FileStreams(id INTEGER PRIMARY KEY NOT NULL, file_id INTEGER NOT NULL, stream_order INTEGER, start INTEGER, size INTEGER, used INTEGER);");
+		connection.ExecQuery("CREATE INDEX idx_FileStreams_used_size ON FileStreams(used, size, file_id, stream_order, start);");
+	}
+
+	void InsertStream(Connection& connection, int64_t fileId, uint64_t start, uint64_t size, uint64_t used)
+	{
+		SQLQuery query(connection, "INSERT INTO FileStreams(file_id, stream_order, start, size, used) VALUES (?, 1, ?, ?, ?);");
+		query.BindInt64(1, fileId);
+		query.BindInt64(2, start);
+		query.BindInt64(3, size);
+		query.BindInt64(4, used);
+		query.Step();
+	}
+}
+
+TEST(ZC_FreeExtentsIndexTest, BestAndFirstFit)
+{
+	remove(s_extentsDbPath.c_str());
+	Connection connection(s_extentsDbPath, true);
+	PrepareExtentsDb(connection);
+	InsertStream(connection, 1, 0, 4096, 4096); // Fully used
+	InsertStream(connection, 1, 4096, 8192, 0);
+	InsertStream(connection, 2, 12288, 4096, 1000); // The free tail is 3096 bytes
+	InsertStream(connection, 3, 16384, 1024, 0);
+	InsertStream(connection, 3, 17408, 65536, 0);
+
+	FreeExtentsIndex index;
+	index.Load(connection);
+	FreeExtentsIndex::Statistics stats = index.GetStatistics();
+	EXPECT_EQ(4, stats.streams);
+	EXPECT_EQ(3, stats.unusedStreams);
+	EXPECT_EQ(8192 + 3096 + 1024 + 65536, stats.freeSpace);
+
+	StreamInfo found;
+	ASSERT_TRUE(index.FindBestFit(connection, 1024, found));
+	EXPECT_EQ(16384, found.start);
+	ASSERT_TRUE(index.FindBestFit(connection, 2048, found));
+	EXPECT_EQ(12288, found.start);
+	EXPECT_EQ(1000, found.used);
+	ASSERT_TRUE(index.FindBestFit(connection, 8192, found));
+	EXPECT_EQ(4096, found.start);
+	ASSERT_TRUE(index.FindBestFit(connection, 8193, found));
+	EXPECT_EQ(17408, found.start);
+	EXPECT_FALSE(index.FindBestFit(connection, 65537, found));
+
+	StreamsChain_vt firstFit = index.FindFirstFit(connection, 9000, 1);
+	ASSERT_EQ(2, firstFit.size()); // The tails and the streams of the file are skipped
+	EXPECT_EQ(16384, firstFit[0].start);
+	EXPECT_EQ(17408, firstFit[1].start);
+	EXPECT_EQ(3, index.FindFirstFit(connection, 1000000, 0).size());
+
+	found.used = found.size;
+	index.Update(found);
+	EXPECT_FALSE(index.FindBestFit(connection, 8193, found));
+	EXPECT_EQ(2, index.GetStatistics().unusedStreams);
+
+	// The changes, which were rolled back, are reloaded
+	{
+		TransactionGuard transaction = connection.StartTransaction();
+		connection.ExecQuery("UPDATE FileStreams SET used = size WHERE start = 17408;");
+	}
+	ASSERT_TRUE(index.FindBestFit(connection, 8193, found));
+	EXPECT_EQ(17408, found.start);
+	EXPECT_EQ(2, index.GetStatistics().loads);
+
+	connection.ExecQuery("UPDATE FileStreams SET used = 0 WHERE file_id = 2;");
+	index.UpdateFile(connection, 2);
+	EXPECT_EQ(4, index.GetStatistics().unusedStreams);
+
+	connection.Disconnect();
+	remove(s_extentsDbPath.c_str());
+}
+
+TEST(ZC_FreeExtentsIndexTest, ReleasedStreamsAreReused)
+{
+	const uint64_t fileSize = 100000;
+	ASSERT_TRUE(DatabasePrepare());
+	FolderGuard root = cont->GetRoot();
+	for (int i = 0; i < 3; ++i)
+	{
+		std::stringstream data(std::string(fileSize, 'a' + i));
+		root->CreateFile("file " + std::to_string(i))->Write(data, fileSize);
+	}
+	ContainerInfo info = cont->GetInfo();
+	uint64_t allocated = info->UsedSpace() + info->FreeSpace();
+
+	root->GetChild("file 1")->Remove();
+	root->GetChild("file 0")->AsFile()->Clear();
+	EXPECT_EQ(fileSize, info->UsedSpace());
+
+	std::stringstream data(std::string(2 * fileSize, 'x'));
+	FileGuard file = root->CreateFile("file 3");
+	file->Write(data, 2 * fileSize);
+	EXPECT_EQ(allocated, info->UsedSpace() + info->FreeSpace());
+
+	std::stringstream readData;
+	file->Read(readData, 2 * fileSize);
+	EXPECT_EQ(std::string(2 * fileSize, 'x'), readData.str());
+	std::stringstream notChanged;
+	root->GetChild("file 2")->AsFile()->Read(notChanged, fileSize);
+	EXPECT_EQ(std::string(fileSize, 'c'), notChanged.str());
+}
+
+// Not a test: compares the free streams lookup in FileStreams with the index for the different numbers of streams.
+// Run with --gtest_also_run_disabled_tests
+TEST(ZC_FreeExtentsIndexTest, DISABLED_Benchmark_Allocation)
+{
+	const int lookups = 1000;
+	for (int streamsCount = 1000; streamsCount <= 100000; streamsCount *= 10)
+	{
+		remove(s_extentsDbPath.c_str());
+		Connection connection(s_extentsDbPath, true);
+		PrepareExtentsDb(connection);
+		{
+			TransactionGuard transaction = connection.StartTransaction();
+			for (int i = 0; i < streamsCount; ++i)
+			{
+				uint64_t size = 512 * (1 + i % 128);
+				InsertStream(connection, i, static_cast<uint64_t>(i) * 65536, size, i % 3 == 0 ? 0 : size - 512 * (i % 2));
+			}
+			transaction->Commit();
+		}
+
+		uint64_t queried = 0;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		SQLQuery query(connection, "SELECT id, file_id, stream_order, start, size, used FROM FileStreams WHERE (used = 0 AND size >= ?) OR (size - used >= ?) ORDER BY size;");
+		for (int i = 0; i < lookups; ++i)
+		{
+			uint64_t size = 512 * (1 + i % 200);
+			query.BindInt64(1, size);
+			query.BindInt64(2, size);
+			queried += query.Step() ? query.ColumnInt64(4) : 0;
+			query.Reset();
+		}
+		std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+		FreeExtentsIndex index;
+		index.Load(connection);
+		std::chrono::steady_clock::time_point loaded = std::chrono::steady_clock::now();
+		uint64_t indexed = 0;
+		for (int i = 0; i < lookups; ++i)
+		{
+			StreamInfo found;
+			indexed += index.FindBestFit(connection, 512 * (1 + i % 200), found) ? found.size : 0;
+		}
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+		EXPECT_GT(queried, 0);
+		EXPECT_GT(indexed, 0);
+		std::cout << streamsCount << " streams, " << lookups << " lookups: query " << std::chrono::duration_cast<std::chrono::microseconds>(middle - start).count()
+			<< " us, index " << std::chrono::duration_cast<std::chrono::microseconds>(end - loaded).count()
+			<< " us (loaded in " << std::chrono::duration_cast<std::chrono::microseconds>(loaded - middle).count() << " us)" << std::endl;
+		connection.Disconnect();
+	}
+	remove(s_extentsDbPath.c_str());
+}
@@ -0,0 +1,108 @@
+#include "stdafx.h"
+#include "ContainerAPI.h"
+#include "ContainerException.h"
+#include "impl/Connection.h"
+#include "Utils.h"
+
+using namespace dbc;
+
+extern std::string db_path;
+extern std::string pass;
+
+extern ContainerGuard cont;
+
+namespace
+{
+	int CountUnusedStreams(Connection& connection)
+	{
+		SQLQuery query(connection, "SELECT count(*) FROM FileStreams WHERE used = 0;");
+		query.Step();
+		return query.ColumnInt(0);
+	}
+}
+
+TEST(ZD_CoalescingTest, ReleasedStreamsAreMerged)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	unsigned int clusterSize = PrepareContainerForPartialWriteTest(cont, false);
+	FolderGuard root = cont->GetRoot();
+	for (int i = 0; i < 3; ++i)
+	{
+		std::stringstream data(std::string(clusterSize, 'a' + i));
+		root->CreateFile("file " + std::to_string(i))->Write(data, clusterSize);
+	}
+	ContainerInfo info = cont->GetInfo();
+	uint64_t allocated = info->UsedSpace() + info->FreeSpace();
+
+	// The streams of the first two files are adjacent
+	root->GetChild("file 0")->Remove();
+	root->GetChild("file 1")->Remove();
+
+	std::stringstream data(std::string(2 * clusterSize, 'x'));
+	FileGuard file = root->CreateFile("file 3");
+	file->Write(data, 2 * clusterSize);
+	File::SpaceUsageInfo usage = file->GetSpaceUsageInfo();
+	EXPECT_EQ(1, usage.streamsTotal);
+	EXPECT_EQ(2 * clusterSize, usage.spaceAvailable);
+	EXPECT_EQ(allocated, info->UsedSpace() + info->FreeSpace());
+
+	std::stringstream readData;
+	file->Read(readData, 2 * clusterSize);
+	EXPECT_EQ(std::string(2 * clusterSize, 'x'), readData.str());
+	std::stringstream notChanged;
+	root->GetChild("file 2")->AsFile()->Read(notChanged, clusterSize);
+	EXPECT_EQ(std::string(clusterSize, 'c'), notChanged.str());
+}
+
+TEST(ZD_CoalescingTest, FreeSpaceOfOldContainerIsMerged)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	unsigned int clusterSize = PrepareContainerForPartialWriteTest(cont, false);
+	FolderGuard root = cont->GetRoot();
+	std::stringstream data(std::string(4 * clusterSize, 'a'));
+	root->CreateFile("file")->Write(data, 4 * clusterSize);
+	root->GetChild("file")->Remove();
+	EXPECT_EQ(0, cont->CoalesceFreeSpace());
+	root.reset();
+	DatabaseDisconnect();
+
+	// The released stream is split as it would be left by the versions without coalescing
+	{
+		Connection connection(db_path, false);
+		ASSERT_EQ(1, CountUnusedStreams(connection));
+		SQLQuery query(connection, "SELECT id, file_id, start FROM FileStreams WHERE used = 0;");
+		ASSERT_TRUE(query.Step());
+		int64_t id = query.ColumnInt64(0);
+		int64_t fileId = query.ColumnInt64(1);
+		int64_t start = query.ColumnInt64(2);
+		query.Prepare("UPDATE FileStreams SET size = ? WHERE id = ?;");
+		query.BindInt64(1, clusterSize);
+		query.BindInt64(2, id);
+		query.Step();
+		query.Prepare("INSERT INTO FileStreams(file_id, stream_order, start, size, used) VALUES (?, ?, ?, ?, 0);");
+		for (int i = 1; i < 4; ++i)
+		{
+			query.Reset();
+			query.BindInt64(1, fileId);
+			query.BindInt64(2, i + 1);
+			query.BindInt64(3, start + i * clusterSize);
+			query.BindInt64(4, clusterSize);
+			query.Step();
+		}
+		ASSERT_EQ(4, CountUnusedStreams(connection));
+	}
+
+	DatabaseConnect();
+	ContainerInfo info = cont->GetInfo();
+	uint64_t freeSpace = info->FreeSpace();
+	EXPECT_EQ(3, cont->CoalesceFreeSpace());
+	EXPECT_EQ(0, cont->CoalesceFreeSpace());
+	EXPECT_EQ(freeSpace, info->FreeSpace());
+	DatabaseDisconnect();
+
+	Connection connection(db_path, false);
+	EXPECT_EQ(1, CountUnusedStreams(connection));
+	SQLQuery query(connection, "SELECT size FROM FileStreams WHERE used = 0;");
+	ASSERT_TRUE(query.Step());
+	EXPECT_EQ(4 * clusterSize, query.ColumnInt64(0));
+}
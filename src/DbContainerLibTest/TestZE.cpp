@@ -0,0 +1,97 @@
+#include "stdafx.h"
+#include "ContainerAPI.h"
+#include "ContainerException.h"
+#include "Utils.h"
+
+using namespace dbc;
+
+extern std::string bin_path;
+
+extern ContainerGuard cont;
+
+namespace
+{
+	uint64_t BinFileSize()
+	{
+		std::ifstream bin(bin_path, std::ios::binary | std::ios::ate);
+		return static_cast<uint64_t>(bin.tellg());
+	}
+
+	void WriteFile(FolderGuard folder, const std::string& name, size_t size, char fill)
+	{
+		std::stringstream data(std::string(size, fill));
+		folder->CreateFile(name)->Write(data, size);
+	}
+
+	void SetStorageGrowth(DataStorageGrowth growth)
+	{
+		DataUsagePreferences prefs = cont->GetDataUsagePreferences();
+		prefs.SetStorageGrowth(growth);
+		cont->SetDataUsagePreferences(prefs);
+	}
+}
+
+TEST(ZE_StorageGrowthTest, TailIsPreallocated)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	SetStorageGrowth(DataStorageGrowthGeometric);
+	ContainerInfo info = cont->GetInfo();
+	EXPECT_EQ(0, info->ReservedSpace());
+
+	FolderGuard root = cont->GetRoot();
+	WriteFile(root, "file 1", 1000, 'a');
+	uint64_t reserved = info->ReservedSpace();
+	EXPECT_GT(reserved, 0);
+	uint64_t binSize = BinFileSize();
+	EXPECT_EQ(0, binSize % (1024 * 1024));
+
+	// The new streams are appended into the preallocated tail
+	uint64_t streamsSize = info->UsedSpace() + info->FreeSpace();
+	WriteFile(root, "file 2", 1000, 'b');
+	uint64_t appended = info->UsedSpace() + info->FreeSpace() - streamsSize;
+	EXPECT_GT(appended, 0);
+	EXPECT_EQ(reserved - appended, info->ReservedSpace());
+	EXPECT_EQ(binSize, BinFileSize());
+
+	std::stringstream data;
+	root->GetChild("file 1")->AsFile()->Read(data, 1000);
+	EXPECT_EQ(std::string(1000, 'a'), data.str());
+}
+
+TEST(ZE_StorageGrowthTest, ExactGrowth)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	SetStorageGrowth(DataStorageGrowthExact);
+	ContainerInfo info = cont->GetInfo();
+	uint64_t binSize = BinFileSize();
+
+	WriteFile(cont->GetRoot(), "file", 1000, 'a');
+	EXPECT_EQ(0, info->ReservedSpace());
+	EXPECT_EQ(binSize + info->UsedSpace() + info->FreeSpace(), BinFileSize());
+}
+
+TEST(ZE_StorageGrowthTest, ReservedTailIsReusedAfterReconnect)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	SetStorageGrowth(DataStorageGrowthChunked);
+	WriteFile(cont->GetRoot(), "file 1", 1000, 'a');
+	uint64_t reserved = cont->GetInfo()->ReservedSpace();
+	ASSERT_GT(reserved, 0);
+	uint64_t binSize = BinFileSize();
+	DatabaseDisconnect();
+
+	DatabaseConnect();
+	ContainerInfo info = cont->GetInfo();
+	EXPECT_EQ(reserved, info->ReservedSpace());
+	FolderGuard root = cont->GetRoot();
+	WriteFile(root, "file 2", 1000, 'b');
+	EXPECT_LT(info->ReservedSpace(), reserved);
+	EXPECT_EQ(binSize, BinFileSize());
+
+	std::stringstream data1;
+	root->GetChild("file 1")->AsFile()->Read(data1, 1000);
+	EXPECT_EQ(std::string(1000, 'a'), data1.str());
+	std::stringstream data2;
+	root->GetChild("file 2")->AsFile()->Read(data2, 1000);
+	EXPECT_EQ(std::string(1000, 'b'), data2.str());
+}
@@ -0,0 +1,105 @@
+#include "stdafx.h"
+#include "ContainerAPI.h"
+#include "ContainerException.h"
+#include "impl/Container.h"
+#include "Utils.h"
+#include <chrono>
+
+using namespace dbc;
+
+extern ContainerGuard cont;
+
+namespace
+{
+	// Leaves the requested number of one cluster unused streams, which can't be merged: the used streams are between them
+	unsigned int PrepareFragmentedContainer(int freeStreams, bool transactionalWrite)
+	{
+		unsigned int clusterSize = PrepareContainerForPartialWriteTest(cont, transactionalWrite);
+		FolderGuard root = cont->GetRoot();
+		std::stringstream data(std::string(clusterSize, 'a'));
+		for (int i = 0; i < freeStreams * 2; ++i)
+		{
+			data.clear();
+			data.seekg(0);
+			root->CreateFile("file " + std::to_string(i))->Write(data, clusterSize);
+		}
+		for (int i = 0; i < freeStreams * 2; i += 2)
+		{
+			root->GetChild("file " + std::to_string(i))->Remove();
+		}
+		return clusterSize;
+	}
+
+	uint64_t StatementsExecuted()
+	{
+		StatementsCache::Statistics stats = dynamic_cast<Container*>(cont.get())->GetConnection().Statements().GetStatistics();
+		return stats.hits + stats.misses;
+	}
+}
+
+TEST(ZF_BatchedStreamsUpdateTest, WriteToManyStreams)
+{
+	const int freeStreams = 100;
+	ASSERT_TRUE(DatabasePrepare());
+	unsigned int clusterSize = PrepareFragmentedContainer(freeStreams, false);
+	ContainerInfo info = cont->GetInfo();
+	uint64_t totalStreams = info->TotalStreams();
+
+	const uint64_t size = static_cast<uint64_t>(clusterSize) * freeStreams;
+	std::stringstream data(std::string(static_cast<size_t>(size), 'x'));
+	FileGuard file = cont->GetRoot()->CreateFile("big");
+	uint64_t statements = StatementsExecuted();
+	file->Write(data, size);
+	EXPECT_LT(StatementsExecuted() - statements, static_cast<uint64_t>(freeStreams / 2)); // Not a statement per stream
+	EXPECT_EQ(totalStreams, info->TotalStreams());
+	EXPECT_EQ(freeStreams, file->GetSpaceUsageInfo().streamsUsed);
+
+	std::stringstream readData;
+	file->Read(readData, size);
+	EXPECT_EQ(data.str(), readData.str());
+}
+
+TEST(ZF_BatchedStreamsUpdateTest, TransactionalRewriteReleasesManyStreams)
+{
+	const int freeStreams = 100;
+	ASSERT_TRUE(DatabasePrepare());
+	unsigned int clusterSize = PrepareFragmentedContainer(freeStreams, true);
+	const uint64_t size = static_cast<uint64_t>(clusterSize) * freeStreams;
+	std::stringstream data(std::string(static_cast<size_t>(size), 'x'));
+	FileGuard file = cont->GetRoot()->CreateFile("big");
+	file->Write(data, size);
+	ASSERT_EQ(freeStreams, file->GetSpaceUsageInfo().streamsUsed);
+
+	std::stringstream newData(std::string(static_cast<size_t>(size), 'y'));
+	uint64_t statements = StatementsExecuted();
+	file->Write(newData, size);
+	EXPECT_LT(StatementsExecuted() - statements, static_cast<uint64_t>(freeStreams / 2));
+	File::SpaceUsageInfo usage = file->GetSpaceUsageInfo();
+	EXPECT_EQ(1, usage.streamsUsed); // The new stream, the old ones are released
+	EXPECT_EQ(size, usage.spaceUsed);
+
+	std::stringstream readData;
+	file->Read(readData, size);
+	EXPECT_EQ(newData.str(), readData.str());
+}
+
+// Not a test: the statements and the time of the writes spanning the different numbers of streams.
+// Run with --gtest_also_run_disabled_tests
+TEST(ZF_BatchedStreamsUpdateTest, DISABLED_Benchmark_WriteToManyStreams)
+{
+	for (int freeStreams = 100; freeStreams <= 10000; freeStreams *= 10)
+	{
+		ASSERT_TRUE(DatabasePrepare());
+		unsigned int clusterSize = PrepareFragmentedContainer(freeStreams, false);
+		const uint64_t size = static_cast<uint64_t>(clusterSize) * freeStreams;
+		std::stringstream data(std::string(static_cast<size_t>(size), 'x'));
+		FileGuard file = cont->GetRoot()->CreateFile("big");
+
+		uint64_t statements = StatementsExecuted();
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		file->Write(data, size);
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+		std::cout << freeStreams << " streams: " << StatementsExecuted() - statements << " statements, "
+			<< std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() << " us" << std::endl;
+	}
+}
@@ -0,0 +1,102 @@
+#include "stdafx.h"
+#include "ContainerAPI.h"
+#include "ContainerException.h"
+#include "Utils.h"
+
+using namespace dbc;
+
+extern ContainerGuard cont;
+
+namespace
+{
+	std::string TestData(size_t size)
+	{
+		std::string data(size, '\0');
+		for (size_t i = 0; i < size; ++i)
+		{
+			data[i] = static_cast<char>('a' + i % 26);
+		}
+		return data;
+	}
+
+	std::string ReadFile(FileGuard file)
+	{
+		std::stringstream data;
+		file->Read(data);
+		return data.str();
+	}
+}
+
+TEST(ZG_FileWriterTest, SmallChunksAreWrittenToOneStream)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	unsigned int clusterSize = PrepareContainerForPartialWriteTest(cont, false);
+	FileGuard file = cont->GetRoot()->CreateFile("file");
+	const std::string data = TestData(clusterSize * 10);
+	{
+		FileWriterGuard writer = file->OpenWriter();
+		for (size_t written = 0; written < data.size(); written += 100)
+		{
+			writer->Write(data.data() + written, data.size() - written < 100 ? data.size() - written : 100);
+		}
+		EXPECT_EQ(data.size(), writer->Written());
+		EXPECT_EQ(0, file->Size()); // Nothing is flushed yet
+		writer->Close();
+	}
+
+	EXPECT_EQ(data.size(), file->Size());
+	File::SpaceUsageInfo usage = file->GetSpaceUsageInfo();
+	EXPECT_EQ(1, usage.streamsTotal);
+	EXPECT_EQ(data.size(), usage.spaceAvailable);
+	EXPECT_EQ(data, ReadFile(file));
+}
+
+TEST(ZG_FileWriterTest, BufferIsFlushed)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	unsigned int clusterSize = PrepareContainerForPartialWriteTest(cont, false);
+	FileGuard file = cont->GetRoot()->CreateFile("file");
+	const std::string data = TestData(clusterSize * 5 + 100);
+	std::stringstream source(data);
+	{
+		FileWriterGuard writer = file->OpenWriter(clusterSize);
+		EXPECT_EQ(clusterSize + 10, writer->Write(source, clusterSize + 10));
+		EXPECT_EQ(clusterSize, file->Size());
+		EXPECT_EQ(data.size() - clusterSize - 10, writer->Write(source, data.size()));
+		EXPECT_EQ(clusterSize * 5, file->Size());
+		// Closed by the destructor
+	}
+
+	EXPECT_EQ(data.size(), file->Size());
+	EXPECT_EQ(data, ReadFile(file));
+}
+
+TEST(ZG_FileWriterTest, ContentIsReplaced)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	unsigned int clusterSize = PrepareContainerForPartialWriteTest(cont, true);
+	FileGuard file = cont->GetRoot()->CreateFile("file");
+	// The file gets the unused streams before and after its used ones
+	std::stringstream oldData(TestData(clusterSize * 3));
+	file->Write(oldData, clusterSize);
+	oldData.seekg(0);
+	file->Write(oldData, clusterSize * 3);
+
+	const std::string data = TestData(clusterSize * 7 + 10);
+	FileWriterGuard writer = file->OpenWriter(clusterSize * 2);
+	EXPECT_ANY_THROW(file->Write(oldData, clusterSize)); // Locked by the writer
+	for (size_t written = 0; written < data.size(); written += clusterSize / 2)
+	{
+		writer->Write(data.data() + written, data.size() - written < clusterSize / 2 ? data.size() - written : clusterSize / 2);
+	}
+	writer->Close();
+	EXPECT_TRUE(writer->IsClosed());
+	EXPECT_ANY_THROW(writer->Write(data.data(), 1));
+
+	EXPECT_EQ(data.size(), file->Size());
+	EXPECT_EQ(data, ReadFile(file));
+
+	FileWriterGuard emptyWriter = file->OpenWriter();
+	emptyWriter->Close();
+	EXPECT_EQ(0, file->Size());
+}
@@ -0,0 +1,140 @@
+#include "stdafx.h"
+#include "ContainerAPI.h"
+#include "ContainerException.h"
+#include "Utils.h"
+
+using namespace dbc;
+
+extern ContainerGuard cont;
+
+namespace
+{
+	const unsigned int s_threshold = 4096;
+
+	void PrepareContainerForInlineData(ContainerGuard container)
+	{
+		DataUsagePreferences prefs = container->GetDataUsagePreferences();
+		prefs.SetInlineDataThreshold(s_threshold);
+		prefs.SetTailPacking(false);
+		container->SetDataUsagePreferences(prefs);
+	}
+
+	void WriteFile(FileGuard file, const std::string& data)
+	{
+		std::stringstream in(data);
+		EXPECT_EQ(data.size(), file->Write(in, data.size()));
+	}
+
+	std::string ReadFile(FileGuard file)
+	{
+		std::stringstream out;
+		file->Read(out);
+		return out.str();
+	}
+}
+
+TEST(ZH_InlineDataTest, SmallFileIsStoredInline)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	PrepareContainerForInlineData(cont);
+	FolderGuard folder = cont->GetRoot()->CreateFolder("folder");
+	FileGuard file = folder->CreateFile("file");
+	const std::string data(200, 'a');
+	WriteFile(file, data);
+
+	File::SpaceUsageInfo usage = file->GetSpaceUsageInfo();
+	EXPECT_EQ(0, usage.streamsTotal);
+	EXPECT_EQ(data.size(), file->Size());
+	EXPECT_EQ(data, ReadFile(file));
+	ContainerInfo info = cont->GetInfo();
+	EXPECT_EQ(data.size(), info->InlineSpace());
+	EXPECT_EQ(0, info->UsedSpace());
+	EXPECT_EQ(data.size(), cont->GetRoot()->TotalSize());
+
+	std::stringstream part;
+	EXPECT_EQ(10, file->Read(part, 10));
+	EXPECT_EQ(std::string(10, 'a'), part.str());
+
+	folder.reset();
+	file.reset();
+	DatabaseDisconnect();
+	DatabaseConnect();
+	EXPECT_EQ(data, ReadFile(cont->GetElement("/folder/file")->AsFile()->Clone()));
+}
+
+TEST(ZH_InlineDataTest, FileCrossesThreshold)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	PrepareContainerForInlineData(cont);
+	FileGuard file = cont->GetRoot()->CreateFile("file");
+	ContainerInfo info = cont->GetInfo();
+
+	WriteFile(file, std::string(100, 'a'));
+	const std::string large(s_threshold * 3, 'b');
+	WriteFile(file, large);
+	EXPECT_EQ(0, info->InlineSpace());
+	EXPECT_EQ(large.size(), info->UsedSpace());
+	EXPECT_EQ(large.size(), file->Size());
+	EXPECT_EQ(large, ReadFile(file));
+
+	const std::string small(s_threshold - 1, 'c');
+	WriteFile(file, small);
+	EXPECT_EQ(small.size(), info->InlineSpace());
+	EXPECT_EQ(0, info->UsedSpace());
+	EXPECT_EQ(0, file->GetSpaceUsageInfo().streamsUsed);
+	EXPECT_EQ(small, ReadFile(file));
+	EXPECT_EQ(small.size(), cont->GetRoot()->TotalSize());
+
+	file->Clear();
+	EXPECT_EQ(0, file->Size());
+	EXPECT_EQ(0, info->InlineSpace());
+	EXPECT_EQ(0, cont->GetRoot()->TotalSize());
+}
+
+TEST(ZH_InlineDataTest, AggregatesCountInlineData)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	PrepareContainerForInlineData(cont);
+	FolderGuard root = cont->GetRoot();
+	FolderGuard folder1 = root->CreateFolder("folder1");
+	FolderGuard folder2 = root->CreateFolder("folder2");
+	FileGuard file = folder1->CreateFile("file");
+	WriteFile(file, std::string(300, 'a'));
+	WriteFile(folder2->CreateFile("other"), std::string(500, 'b'));
+	EXPECT_EQ(300, folder1->TotalSize());
+
+	file->MoveToEntry(*folder2);
+	EXPECT_EQ(0, folder1->TotalSize());
+	EXPECT_EQ(800, folder2->TotalSize());
+
+	file->Remove();
+	EXPECT_EQ(500, folder2->TotalSize());
+	EXPECT_EQ(500, root->TotalSize());
+
+	folder2->Remove();
+	EXPECT_EQ(0, root->TotalSize());
+	EXPECT_EQ(0, cont->GetInfo()->InlineSpace());
+}
+
+TEST(ZH_InlineDataTest, WriterMovesDataToStreams)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	PrepareContainerForInlineData(cont);
+	FileGuard file = cont->GetRoot()->CreateFile("file");
+	std::string data;
+	for (size_t i = 0; i < s_threshold * 2; ++i)
+	{
+		data.push_back(static_cast<char>('a' + i % 26));
+	}
+
+	FileWriterGuard writer = file->OpenWriter(1000);
+	writer->Write(data.data(), 2500);
+	EXPECT_EQ(2000, file->Size());
+	EXPECT_EQ(2000, cont->GetInfo()->InlineSpace());
+	writer->Write(data.data() + 2500, data.size() - 2500);
+	writer->Close();
+
+	EXPECT_EQ(0, cont->GetInfo()->InlineSpace());
+	EXPECT_EQ(data.size(), file->Size());
+	EXPECT_EQ(data, ReadFile(file));
+}
@@ -0,0 +1,151 @@
+#include "stdafx.h"
+#include "ContainerAPI.h"
+#include "ContainerException.h"
+#include "Utils.h"
+
+using namespace dbc;
+
+extern ContainerGuard cont;
+
+namespace
+{
+	unsigned int PrepareContainerForTailPacking(ContainerGuard container, unsigned short clusterSizeLevel) // returns cluster size
+	{
+		DataUsagePreferences prefs = container->GetDataUsagePreferences();
+		prefs.SetClusterSizeLevel(clusterSizeLevel);
+		prefs.SetTailPacking(true);
+		prefs.SetInlineDataThreshold(0); // The preferences are kept by the container between the tests
+		container->SetDataUsagePreferences(prefs);
+		return prefs.ClusterSize();
+	}
+
+	std::string TestData(size_t size, char first)
+	{
+		std::string data(size, '\0');
+		for (size_t i = 0; i < size; ++i)
+		{
+			data[i] = static_cast<char>(first + i % 26);
+		}
+		return data;
+	}
+
+	FileGuard WriteFile(FileGuard file, const std::string& data)
+	{
+		std::stringstream in(data);
+		EXPECT_EQ(data.size(), file->Write(in, data.size()));
+		return file;
+	}
+
+	std::string ReadFile(FileGuard file)
+	{
+		std::stringstream out;
+		file->Read(out);
+		return out.str();
+	}
+}
+
+TEST(ZI_TailPackingTest, TailsShareBlock)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	unsigned int clusterSize = PrepareContainerForTailPacking(cont, DataUsagePreferences::CLUSTER_SIZE_MAX);
+	FolderGuard root = cont->GetRoot();
+	const std::string data1 = TestData(1000, 'a');
+	const std::string data2 = TestData(2000, 'b');
+	const std::string data3 = TestData(clusterSize + 4464, 'c');
+	FileGuard file1 = WriteFile(root->CreateFile("file1"), data1);
+	FileGuard file2 = WriteFile(root->CreateFile("file2"), data2);
+	FileGuard file3 = WriteFile(root->CreateFile("file3"), data3);
+
+	EXPECT_EQ(0, file1->GetSpaceUsageInfo().streamsTotal);
+	EXPECT_EQ(0, file2->GetSpaceUsageInfo().streamsTotal);
+	File::SpaceUsageInfo usage = file3->GetSpaceUsageInfo();
+	EXPECT_EQ(1, usage.streamsTotal);
+	EXPECT_EQ(clusterSize, usage.spaceAvailable);
+
+	ContainerInfo info = cont->GetInfo();
+	EXPECT_EQ(clusterSize, info->UsedSpace());
+	EXPECT_EQ(1000 + 2000 + 4464, info->TailsSpace());
+	EXPECT_LT(0, info->TailBlocksSpace());
+	EXPECT_EQ(data1.size() + data2.size() + data3.size(), root->TotalSize());
+	EXPECT_EQ(data3.size(), file3->Size());
+
+	EXPECT_EQ(data1, ReadFile(file1));
+	EXPECT_EQ(data2, ReadFile(file2));
+	EXPECT_EQ(data3, ReadFile(file3));
+	std::stringstream part;
+	EXPECT_EQ(clusterSize + 10, file3->Read(part, clusterSize + 10));
+	EXPECT_EQ(data3.substr(0, clusterSize + 10), part.str());
+
+	file1.reset();
+	file2.reset();
+	file3.reset();
+	root.reset();
+	DatabaseDisconnect();
+	DatabaseConnect();
+	EXPECT_EQ(data1, ReadFile(cont->GetElement("/file1")->AsFile()->Clone()));
+	EXPECT_EQ(data3, ReadFile(cont->GetElement("/file3")->AsFile()->Clone()));
+}
+
+TEST(ZI_TailPackingTest, FreedTailsAreReused)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	PrepareContainerForTailPacking(cont, DataUsagePreferences::CLUSTER_SIZE_MAX);
+	FolderGuard root = cont->GetRoot();
+	WriteFile(root->CreateFile("file1"), TestData(1000, 'a'));
+	const std::string data2 = TestData(1000, 'b');
+	FileGuard file2 = WriteFile(root->CreateFile("file2"), data2);
+	ContainerInfo info = cont->GetInfo();
+	uint64_t blocksSpace = info->TailBlocksSpace();
+
+	root->GetChild("file1")->Remove();
+	EXPECT_EQ(1000, info->TailsSpace());
+	const std::string data3 = TestData(500, 'c');
+	FileGuard file3 = WriteFile(root->CreateFile("file3"), data3);
+	const std::string rewritten = TestData(3000, 'd');
+	WriteFile(file2, rewritten);
+
+	EXPECT_EQ(blocksSpace, info->TailBlocksSpace());
+	EXPECT_EQ(3500, info->TailsSpace());
+	EXPECT_EQ(rewritten, ReadFile(file2));
+	EXPECT_EQ(data3, ReadFile(file3));
+
+	file3->Clear();
+	EXPECT_EQ(0, file3->Size());
+	file2->Remove();
+	EXPECT_EQ(0, info->TailsSpace());
+	EXPECT_EQ(0, root->TotalSize());
+}
+
+TEST(ZI_TailPackingTest, TailIsMovedByAppend)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	unsigned int clusterSize = PrepareContainerForTailPacking(cont, DataUsagePreferences::CLUSTER_SIZE_MIN);
+	FileGuard file = cont->GetRoot()->CreateFile("file");
+	const std::string data = TestData(clusterSize * 4 + 100, 'a');
+	{
+		FileWriterGuard writer = file->OpenWriter(clusterSize + clusterSize / 2);
+		writer->Write(data.data(), data.size());
+	}
+
+	EXPECT_EQ(data.size(), file->Size());
+	EXPECT_EQ(data, ReadFile(file));
+	EXPECT_EQ(100, cont->GetInfo()->TailsSpace());
+	EXPECT_EQ(clusterSize * 4, cont->GetInfo()->UsedSpace());
+}
+
+TEST(ZI_TailPackingTest, TailIsMovedToStreamsWithoutPacking)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	unsigned int clusterSize = PrepareContainerForTailPacking(cont, DataUsagePreferences::CLUSTER_SIZE_MIN);
+	FileGuard file = WriteFile(cont->GetRoot()->CreateFile("file"), TestData(clusterSize + 10, 'a'));
+	EXPECT_EQ(10, cont->GetInfo()->TailsSpace());
+
+	DataUsagePreferences prefs = cont->GetDataUsagePreferences();
+	prefs.SetTailPacking(false);
+	cont->SetDataUsagePreferences(prefs);
+	const std::string data = TestData(clusterSize + 20, 'b');
+	WriteFile(file, data);
+	EXPECT_EQ(0, cont->GetInfo()->TailsSpace());
+	EXPECT_EQ(data.size(), cont->GetInfo()->UsedSpace());
+	EXPECT_EQ(data, ReadFile(file));
+}
@@ -0,0 +1,117 @@
+#include "stdafx.h"
+#include "ContainerAPI.h"
+#include "ContainerException.h"
+#include "impl/WorkloadTuner.h"
+#include "Utils.h"
+
+using namespace dbc;
+
+extern ContainerGuard cont;
+
+namespace
+{
+	DataUsagePreferences PrepareContainerForTuning(ContainerGuard container, unsigned short clusterSizeLevel, bool adaptive, bool autoTune)
+	{
+		DataUsagePreferences prefs = container->GetDataUsagePreferences();
+		prefs.SetClusterSizeLevel(clusterSizeLevel);
+		prefs.SetAdaptiveClusterSize(adaptive);
+		prefs.SetAutoTune(autoTune);
+		prefs.SetInlineDataThreshold(0); // The preferences are kept by the container between the tests
+		prefs.SetTailPacking(false);
+		container->SetDataUsagePreferences(prefs);
+		return prefs;
+	}
+
+	void WriteFile(FolderGuard folder, const std::string& name, size_t size)
+	{
+		std::stringstream in(std::string(size, 'a'));
+		EXPECT_EQ(size, folder->CreateFile(name)->Write(in, size));
+	}
+}
+
+TEST(ZJ_TuningTest, PreferencesAreSavedInContainer)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	PrepareContainerForTuning(cont, DataUsagePreferences::CLUSTER_SIZE_MIN, false, false);
+	DataUsagePreferences prefs(5, DataFragmentationLevelMin, false, DataStorageGrowthChunked, 1000, true);
+	prefs.SetAdaptiveClusterSize(true);
+	cont->SetDataUsagePreferences(prefs);
+
+	DatabaseDisconnect();
+	DatabaseConnect();
+	DataUsagePreferences saved = cont->GetDataUsagePreferences();
+	EXPECT_EQ(5, saved.ClusterSizeLevel());
+	EXPECT_EQ(DataFragmentationLevelMin, saved.FragmentationLevel());
+	EXPECT_FALSE(saved.TransactionalWrite());
+	EXPECT_EQ(DataStorageGrowthChunked, saved.StorageGrowth());
+	EXPECT_EQ(1000, saved.InlineDataThreshold());
+	EXPECT_TRUE(saved.TailPacking());
+	EXPECT_TRUE(saved.AdaptiveClusterSize());
+	EXPECT_FALSE(saved.AutoTune());
+
+	cont->SetDataUsagePreferences(DataUsagePreferences());
+}
+
+TEST(ZJ_TuningTest, AdaptiveClusterSizeFollowsWriteSize)
+{
+	DataUsagePreferences prefs(DataUsagePreferences::CLUSTER_SIZE_MAX);
+	EXPECT_EQ(prefs.ClusterSize(), prefs.ClusterSizeFor(100));
+	prefs.SetAdaptiveClusterSize(true);
+	EXPECT_EQ(DataUsagePreferences::GetRealClusterSize(DataUsagePreferences::CLUSTER_SIZE_MIN), prefs.ClusterSizeFor(100));
+	EXPECT_EQ(DataUsagePreferences::GetRealClusterSize(2), prefs.ClusterSizeFor(16 * 2048));
+	EXPECT_EQ(prefs.ClusterSize(), prefs.ClusterSizeFor(1024 * 1024 * 1024));
+
+	prefs.SetClusterSizeLevel(1);
+	EXPECT_EQ(prefs.ClusterSize(), prefs.ClusterSizeFor(16 * 2048)); // Not more than the cluster size level
+}
+
+TEST(ZJ_TuningTest, AdaptiveWriteUsesSmallCluster)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	PrepareContainerForTuning(cont, DataUsagePreferences::CLUSTER_SIZE_MAX, true, false);
+	FolderGuard root = cont->GetRoot();
+	WriteFile(root, "small", 1000);
+	File::SpaceUsageInfo usage = root->GetChild("small")->AsFile()->GetSpaceUsageInfo();
+	EXPECT_EQ(1000, usage.spaceUsed);
+	EXPECT_LT(usage.spaceAvailable, DataUsagePreferences::GetRealClusterSize(DataUsagePreferences::CLUSTER_SIZE_MAX));
+
+	std::stringstream out;
+	root->GetChild("small")->AsFile()->Read(out);
+	EXPECT_EQ(std::string(1000, 'a'), out.str());
+	PrepareContainerForTuning(cont, DataUsagePreferences::CLUSTER_SIZE_DEF, false, false);
+}
+
+TEST(ZJ_TuningTest, AutoTuneAdjustsToSmallFiles)
+{
+	ASSERT_TRUE(DatabasePrepare());
+	PrepareContainerForTuning(cont, DataUsagePreferences::CLUSTER_SIZE_DEF, false, true);
+	const uint64_t samples = WorkloadTuner::SAMPLES_PER_DECISION;
+	const unsigned short oldLevel = DataUsagePreferences::CLUSTER_SIZE_DEF;
+	const unsigned short newLevel = DataUsagePreferences::CLUSTER_SIZE_MIN;
+	FolderGuard root = cont->GetRoot();
+	for (size_t i = 1; i < samples; ++i)
+	{
+		WriteFile(root, "file " + std::to_string(i), 100);
+	}
+	EXPECT_TRUE(cont->GetTuningDecisions().empty());
+	WriteFile(root, "file 0", 100);
+
+	TuningDecisions_vt decisions = cont->GetTuningDecisions();
+	ASSERT_EQ(1, decisions.size());
+	EXPECT_EQ(samples, decisions[0].samples);
+	EXPECT_EQ(100, decisions[0].medianWriteSize);
+	EXPECT_EQ(oldLevel, decisions[0].oldClusterSizeLevel);
+	EXPECT_EQ(newLevel, decisions[0].newClusterSizeLevel);
+	EXPECT_FALSE(decisions[0].oldTailPacking);
+	EXPECT_TRUE(decisions[0].newTailPacking);
+	EXPECT_FALSE(decisions[0].reason.empty());
+	EXPECT_EQ(newLevel, cont->GetDataUsagePreferences().ClusterSizeLevel());
+	EXPECT_TRUE(cont->GetDataUsagePreferences().TailPacking());
+
+	root.reset();
+	DatabaseDisconnect();
+	DatabaseConnect();
+	EXPECT_EQ(1, cont->GetTuningDecisions().size());
+	EXPECT_EQ(newLevel, cont->GetDataUsagePreferences().ClusterSizeLevel());
+	PrepareContainerForTuning(cont, DataUsagePreferences::CLUSTER_SIZE_DEF, false, false);
+}